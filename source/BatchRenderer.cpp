@@ -0,0 +1,145 @@
+//Standard includes
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+//Project includes
+#include "BatchRenderer.h"
+#include "MemoryRenderTarget.h"
+#include "Renderer.h"
+
+using namespace dae;
+
+BatchRenderer::BatchRenderer(int width, int height, uint32_t nrJobs)
+{
+	if (nrJobs == 0)
+	{
+		nrJobs = std::max(std::thread::hardware_concurrency(), 1u);
+	}
+
+	//A single job gets every thread, otherwise the frames are the parallel work
+	const uint32_t nrThreadsPerJob = nrJobs == 1 ? 0 : 1;
+	for (uint32_t i = 0; i < nrJobs; ++i)
+	{
+		Job job{};
+		job.pRenderTarget = new MemoryRenderTarget(width, height);
+		job.pRenderer = new Renderer(job.pRenderTarget, nrThreadsPerJob);
+		m_Jobs.push_back(job);
+	}
+}
+
+BatchRenderer::~BatchRenderer()
+{
+	for (const Job& job : m_Jobs)
+	{
+		delete job.pRenderer;
+		delete job.pRenderTarget;
+	}
+}
+
+void BatchRenderer::SetCameraPath(std::vector<CameraKeyframe> keyframes)
+{
+	std::stable_sort(keyframes.begin(), keyframes.end(), [](const CameraKeyframe& a, const CameraKeyframe& b) { return a.time < b.time; });
+	m_CameraPath = std::move(keyframes);
+}
+
+bool BatchRenderer::LoadCameraPath(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+		return false;
+
+	std::vector<CameraKeyframe> keyframes{};
+	std::string line{};
+	while (std::getline(file, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream stream{ line };
+		CameraKeyframe keyframe{};
+		if (!(stream >> keyframe.time >> keyframe.origin.x >> keyframe.origin.y >> keyframe.origin.z >> keyframe.pitch >> keyframe.yaw))
+			return false;
+
+		keyframe.pitch *= TO_RADIANS;
+		keyframe.yaw *= TO_RADIANS;
+		keyframes.push_back(keyframe);
+	}
+
+	SetCameraPath(std::move(keyframes));
+	return true;
+}
+
+bool BatchRenderer::Render(int nrFrames, float timeStep, const std::string& outputPrefix)
+{
+	std::atomic<int> nextFrame{ 0 };
+	std::atomic<bool> isSaved{ true };
+
+	//Every job takes the next frame that isn't taken yet, so slow frames don't hold the others up
+	const auto runJob = [&](const Job& job)
+		{
+			for (int frame = nextFrame++; frame < nrFrames; frame = nextFrame++)
+			{
+				if (!RenderFrame(job, frame, timeStep, outputPrefix))
+				{
+					isSaved = false;
+				}
+			}
+		};
+
+	//The calling thread runs the first job
+	std::vector<std::thread> threads{};
+	for (size_t i = 1; i < m_Jobs.size(); ++i)
+	{
+		threads.emplace_back(runJob, std::cref(m_Jobs[i]));
+	}
+	runJob(m_Jobs[0]);
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	return isSaved;
+}
+
+bool BatchRenderer::RenderFrame(const Job& job, int frame, float timeStep, const std::string& outputPrefix) const
+{
+	const float time = frame * timeStep;
+
+	job.pRenderer->SetSceneTime(time);
+	if (!m_CameraPath.empty())
+	{
+		const CameraKeyframe pose = SampleCameraPath(time);
+		job.pRenderer->SetCameraPose(pose.origin, pose.pitch, pose.yaw);
+	}
+	job.pRenderer->Render();
+
+	std::ostringstream path{};
+	path << outputPrefix << std::setw(5) << std::setfill('0') << frame << ".bmp";
+	return !job.pRenderer->SaveBufferToImage(path.str());
+}
+
+CameraKeyframe BatchRenderer::SampleCameraPath(float time) const
+{
+	if (time <= m_CameraPath.front().time)
+		return m_CameraPath.front();
+	if (time >= m_CameraPath.back().time)
+		return m_CameraPath.back();
+
+	//First keyframe after time, the one before it exists because of the checks above
+	const auto next = std::upper_bound(m_CameraPath.begin(), m_CameraPath.end(), time, [](float t, const CameraKeyframe& keyframe) { return t < keyframe.time; });
+	const CameraKeyframe& a = *(next - 1);
+	const CameraKeyframe& b = *next;
+
+	const float factor = (time - a.time) / (b.time - a.time);
+	CameraKeyframe pose{};
+	pose.time = time;
+	pose.origin = a.origin + (b.origin - a.origin) * factor;
+	pose.pitch = Lerpf(a.pitch, b.pitch, factor);
+	pose.yaw = Lerpf(a.yaw, b.yaw, factor);
+	return pose;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//Project includes
+#include "Math.h"
+
+namespace dae
+{
+	class Renderer;
+	class MemoryRenderTarget;
+
+	//Camera pose at a time in the sequence, pitch and yaw in radians
+	struct CameraKeyframe
+	{
+		float time{};
+		Vector3 origin{};
+		float pitch{};
+		float yaw{};
+	};
+
+	//Renders a sequence of frames to image files as fast as possible, without a window or input
+	//Frame i shows the scene at i * timeStep, so the result doesn't depend on how long frames take
+	class BatchRenderer final
+	{
+	public:
+		//nrJobs 1 renders one frame at a time on every hardware thread
+		//More jobs render that many frames at once, each on one thread, which scales better for long sequences
+		//nrJobs 0 uses a job per hardware thread
+		BatchRenderer(int width, int height, uint32_t nrJobs = 0);
+		~BatchRenderer();
+
+		BatchRenderer(const BatchRenderer&) = delete;
+		BatchRenderer(BatchRenderer&&) noexcept = delete;
+		BatchRenderer& operator=(const BatchRenderer&) = delete;
+		BatchRenderer& operator=(BatchRenderer&&) noexcept = delete;
+
+		//The camera moves linearly between keyframes and holds the first and last pose outside of them
+		//Without keyframes the camera stays at its start position and only the scene animates, a turntable
+		void SetCameraPath(std::vector<CameraKeyframe> keyframes);
+		//One keyframe per line: time x y z pitch yaw, with the angles in degrees. Lines starting with # are skipped
+		bool LoadCameraPath(const std::string& path);
+
+		//Saves frame i as outputPrefix followed by i padded to 5 digits and .bmp
+		bool Render(int nrFrames, float timeStep, const std::string& outputPrefix);
+
+		uint32_t GetJobCount() const { return static_cast<uint32_t>(m_Jobs.size()); }
+
+	private:
+		struct Job
+		{
+			MemoryRenderTarget* pRenderTarget{};
+			Renderer* pRenderer{};
+		};
+
+		std::vector<Job> m_Jobs{};
+		std::vector<CameraKeyframe> m_CameraPath{};
+
+		bool RenderFrame(const Job& job, int frame, float timeStep, const std::string& outputPrefix) const;
+		CameraKeyframe SampleCameraPath(float time) const;
+	};
+}
@@ -34,6 +34,12 @@ namespace dae
 		Matrix invViewMatrix{};
 		Matrix viewMatrix{};
 		Matrix projectionMatrix{};
+		//Same projection with near and far swapped, z / w goes from 1 at the near plane to 0 at the far plane
+		Matrix reversedProjectionMatrix{};
+
+		//World space planes as (normal, distance), the inside is positive
+		//Left, right, bottom, top, near, far
+		Vector4 frustumPlanes[6]{};
 
 		void Initialize(float _aspectRatio, float _fovAngle = 90.f, const Vector3& _origin = {0.f,0.f,0.f})
 		{
@@ -42,6 +48,8 @@ namespace dae
 			fov = tanf((fovAngle * TO_RADIANS) / 2.f);
 
 			origin = _origin;
+			//The view is valid before the first update, renders that skip Update rely on it
+			CalculateViewMatrix();
 			CalculateProjectionMatrix();
 		}
 
@@ -58,6 +66,7 @@ namespace dae
 			};
 
 			viewMatrix = invViewMatrix.Inverse();
+			CalculateFrustumPlanes();
 
 			//TODO W1
 			//ONB => invViewMatrix
@@ -70,12 +79,39 @@ namespace dae
 		void CalculateProjectionMatrix()
 		{
 			projectionMatrix = Matrix::CreatePerspectiveFovLH(fov, aspectRatio, near, far);
+			reversedProjectionMatrix = Matrix::CreatePerspectiveFovLH(fov, aspectRatio, far, near);
+			CalculateFrustumPlanes();
 			//TODO W2
 
 			//ProjectionMatrix => Matrix::CreatePerspectiveFovLH(...) [not implemented yet]
 			//DirectX Implementation => https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixperspectivefovlh
 		}
 
+		void CalculateFrustumPlanes()
+		{
+			//Clip space is point * viewProjection, so every clip coordinate is a column of the matrix
+			const Matrix viewProjection = viewMatrix * projectionMatrix;
+			const auto column = [&](int index)
+				{
+					return Vector4{ viewProjection[0][index], viewProjection[1][index], viewProjection[2][index], viewProjection[3][index] };
+				};
+			const Vector4 x = column(0), y = column(1), z = column(2), w = column(3);
+
+			//-w <= x <= w, -w <= y <= w, 0 <= z <= w
+			frustumPlanes[0] = w + x;
+			frustumPlanes[1] = w - x;
+			frustumPlanes[2] = w + y;
+			frustumPlanes[3] = w - y;
+			frustumPlanes[4] = z;
+			frustumPlanes[5] = w - z;
+
+			//Normalize so the distance to a plane is in world units
+			for (Vector4& plane : frustumPlanes)
+			{
+				plane = plane * (1.f / Vector3{ plane.x, plane.y, plane.z }.Magnitude());
+			}
+		}
+
 		void Update(Timer* pTimer)
 		{
 			const float deltaTime = pTimer->GetElapsed();
@@ -127,6 +163,16 @@ namespace dae
 			//Update Matrices
 			CalculateViewMatrix();
 		}
+		//Pitch and yaw in radians
+		void SetPose(const Vector3& _origin, float pitch, float yaw)
+		{
+			origin = _origin;
+			totalPitch = pitch;
+			totalYaw = yaw;
+
+			forward = Matrix::CreateRotation(totalPitch, totalYaw, 0.f).TransformVector(Vector3::UnitZ);
+			CalculateViewMatrix();
+		}
 		void SetFOVAngle(float _fov)
 		{
 			fovAngle = _fov;
@@ -1,5 +1,7 @@
 #pragma once
+#include "FrameArena.h"
 #include "Math.h"
+#include "SIMD.h"
 #include "vector"
 
 namespace dae
@@ -14,14 +16,49 @@ namespace dae
 		//Vector3 viewDirection{}; //W4
 	};
 
-	struct Vertex_Out
+	//The attributes the pipeline reads, one array per component so LANES vertices are loaded at once
+	struct VertexStreams
 	{
-		Vector4 position{};
-		ColorRGB color{ colors::White };
-		Vector2 uv{};
-		Vector3 normal{};
-		Vector3 tangent{};
-		//Vector3 viewDirection{};
+		simd::AlignedVector<float> positionX{};
+		simd::AlignedVector<float> positionY{};
+		simd::AlignedVector<float> positionZ{};
+		simd::AlignedVector<float> u{};
+		simd::AlignedVector<float> v{};
+	};
+
+	//Lives in the frame arena, Reset has to be called every frame before the streams are filled
+	struct VertexStreams_Out
+	{
+		//Homogeneous clip space
+		ArenaVector<float> positionX{};
+		ArenaVector<float> positionY{};
+		ArenaVector<float> positionZ{};
+		ArenaVector<float> positionW{};
+		//Pixels, only meaningful when w is positive
+		ArenaVector<float> screenX{};
+		ArenaVector<float> screenY{};
+		ArenaVector<float> u{};
+		ArenaVector<float> v{};
+
+		void Reset(FrameArena& arena)
+		{
+			for (ArenaVector<float>* pStream : { &positionX, &positionY, &positionZ, &positionW, &screenX, &screenY, &u, &v })
+			{
+				pStream->Reset(arena);
+			}
+		}
+
+		size_t Size() const { return positionX.size(); }
+		Vector4 GetPosition(size_t index) const { return { positionX[index], positionY[index], positionZ[index], positionW[index] }; }
+	};
+
+	//Object space bounds of a mesh
+	struct Bounds
+	{
+		Vector3 min{};
+		Vector3 max{};
+		Vector3 center{};
+		float radius{};
 	};
 
 	enum class PrimitiveTopology
@@ -30,13 +67,24 @@ namespace dae
 		TriangleStrip
 	};
 
+	//Index of a material in the MaterialCache of the renderer
+	using MaterialHandle = uint32_t;
+	constexpr MaterialHandle INVALID_MATERIAL{ UINT32_MAX };
+
 	struct Mesh
 	{
 		std::vector<Vertex> vertices{};
 		std::vector<uint32_t> indices{};
 		PrimitiveTopology primitiveTopology{ PrimitiveTopology::TriangleStrip };
+		//Copy of vertices split in streams, filled once after loading
+		VertexStreams vertexStreams{};
+		Bounds bounds{};
 
-		std::vector<Vertex_Out> vertices_out{};
+		VertexStreams_Out vertices_out{};
+		//Triangle list that survived primitive assembly, indexes vertices_out
+		ArenaVector<uint32_t> indices_out{};
 		Matrix worldMatrix{};
+		//Holds one reference of the material, shaded white without one
+		MaterialHandle material{ INVALID_MATERIAL };
 	};
 }
\ No newline at end of file
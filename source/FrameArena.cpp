@@ -0,0 +1,77 @@
+#include "FrameArena.h"
+
+#include <new>
+
+using namespace dae;
+
+FrameArena::FrameArena(size_t initialSize)
+{
+	AddBlock(initialSize);
+}
+
+FrameArena::~FrameArena()
+{
+	FreeBlocks();
+}
+
+void* FrameArena::Allocate(size_t size)
+{
+	//Keep the next allocation aligned as well
+	size = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+	if (m_Offset + size > m_Blocks.back().size)
+	{
+		//Doubling keeps the number of blocks of the first frames low
+		AddBlock(std::max(size, m_Blocks.back().size * 2));
+	}
+
+	void* pMemory = m_Blocks.back().pData + m_Offset;
+	m_Offset += size;
+	return pMemory;
+}
+
+void FrameArena::Reset()
+{
+	if (m_Blocks.size() > 1)
+	{
+		//Everything but the unused end of the last block was needed this frame
+		size_t totalSize{ m_Offset };
+		for (size_t i = 0; i < m_Blocks.size() - 1; ++i)
+		{
+			totalSize += m_Blocks[i].size;
+		}
+
+		FreeBlocks();
+		AddBlock(totalSize);
+	}
+
+	m_Offset = 0;
+}
+
+size_t FrameArena::GetCapacity() const
+{
+	size_t capacity{};
+	for (const Block& block : m_Blocks)
+	{
+		capacity += block.size;
+	}
+	return capacity;
+}
+
+void FrameArena::AddBlock(size_t size)
+{
+	Block block{};
+	block.pData = static_cast<std::byte*>(::operator new(size, std::align_val_t{ ALIGNMENT }));
+	block.size = size;
+	m_Blocks.push_back(block);
+	m_Offset = 0;
+}
+
+void FrameArena::FreeBlocks()
+{
+	for (const Block& block : m_Blocks)
+	{
+		::operator delete(block.pData, std::align_val_t{ ALIGNMENT });
+	}
+	m_Blocks.clear();
+}
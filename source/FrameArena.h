@@ -0,0 +1,136 @@
+#pragma once
+
+//Standard includes
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace dae
+{
+	//Linear allocator for data that only lives during one frame, everything is released at once by Reset
+	//Memory grows to the peak frame and is kept, so a steady scene renders without heap allocations
+	class FrameArena final
+	{
+	public:
+		//Every allocation starts at a multiple of the widest vector, so the streams can be walked LANES at a time
+		static constexpr size_t ALIGNMENT{ 32 };
+
+		FrameArena(size_t initialSize = 1 << 20);
+		~FrameArena();
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena(FrameArena&&) noexcept = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+		FrameArena& operator=(FrameArena&&) noexcept = delete;
+
+		void* Allocate(size_t size);
+
+		template<typename T>
+		T* Allocate(size_t count)
+		{
+			static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Arena memory is never destructed");
+			static_assert(alignof(T) <= ALIGNMENT, "Arena memory isn't aligned enough");
+			return static_cast<T*>(Allocate(count * sizeof(T)));
+		}
+
+		//Releases every allocation. When the frame needed more than one block they are merged into one, so the next frame fits
+		void Reset();
+
+		size_t GetCapacity() const;
+
+	private:
+		struct Block
+		{
+			std::byte* pData{};
+			size_t size{};
+		};
+
+		std::vector<Block> m_Blocks{};
+		//Allocations come from the last block
+		size_t m_Offset{};
+
+		void AddBlock(size_t size);
+		void FreeBlocks();
+	};
+
+	//Growable array in a FrameArena, for trivially copyable types only
+	//Named like std::vector so the pipeline reads the same. Growing leaves the old storage behind in the arena until the next reset
+	template<typename T>
+	class ArenaVector final
+	{
+	public:
+		//Drops the contents without freeing them, needed after every reset of the arena before the array is used again
+		void Reset(FrameArena& arena)
+		{
+			m_pArena = &arena;
+			m_pData = nullptr;
+			m_Size = 0;
+			m_Capacity = 0;
+		}
+
+		void reserve(size_t capacity)
+		{
+			if (capacity <= m_Capacity)
+			{
+				return;
+			}
+
+			T* pData = m_pArena->Allocate<T>(capacity);
+			if (m_Size > 0)
+			{
+				std::memcpy(pData, m_pData, m_Size * sizeof(T));
+			}
+			m_pData = pData;
+			m_Capacity = capacity;
+		}
+
+		//New elements are left uninitialized
+		void resize(size_t size)
+		{
+			reserve(size);
+			m_Size = size;
+		}
+
+		template<typename Iterator>
+		void assign(Iterator first, Iterator last)
+		{
+			resize(static_cast<size_t>(std::distance(first, last)));
+			std::copy(first, last, m_pData);
+		}
+
+		//Taken by value, the element could come from this array
+		void push_back(T value)
+		{
+			if (m_Size == m_Capacity)
+			{
+				reserve(std::max<size_t>(m_Capacity * 2, 16));
+			}
+			m_pData[m_Size++] = value;
+		}
+
+		void clear() { m_Size = 0; }
+
+		size_t size() const { return m_Size; }
+		bool empty() const { return m_Size == 0; }
+
+		T* data() { return m_pData; }
+		const T* data() const { return m_pData; }
+		T& operator[](size_t index) { return m_pData[index]; }
+		const T& operator[](size_t index) const { return m_pData[index]; }
+		T& back() { return m_pData[m_Size - 1]; }
+		const T& back() const { return m_pData[m_Size - 1]; }
+
+		T* begin() { return m_pData; }
+		T* end() { return m_pData + m_Size; }
+		const T* begin() const { return m_pData; }
+		const T* end() const { return m_pData + m_Size; }
+
+	private:
+		FrameArena* m_pArena{ nullptr };
+		T* m_pData{ nullptr };
+		size_t m_Size{};
+		size_t m_Capacity{};
+	};
+}
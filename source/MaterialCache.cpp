@@ -0,0 +1,92 @@
+//Standard includes
+#include <cassert>
+
+//Project includes
+#include "MaterialCache.h"
+#include "Texture.h"
+
+using namespace dae;
+
+MaterialCache::~MaterialCache()
+{
+	for (const auto& [path, entry] : m_Textures)
+	{
+		delete entry.pTexture;
+	}
+}
+
+MaterialHandle MaterialCache::CreateMaterial(const std::string& diffusePath)
+{
+	MaterialEntry entry{};
+	entry.material.pDiffuse = AcquireTexture(diffusePath);
+	entry.diffusePath = diffusePath;
+	entry.nrReferences = 1;
+
+	if (!m_FreeMaterials.empty())
+	{
+		const MaterialHandle handle = m_FreeMaterials.back();
+		m_FreeMaterials.pop_back();
+		m_Materials[handle] = std::move(entry);
+		return handle;
+	}
+
+	m_Materials.push_back(std::move(entry));
+	return static_cast<MaterialHandle>(m_Materials.size() - 1);
+}
+
+MaterialHandle MaterialCache::AcquireMaterial(const std::string& diffusePath)
+{
+	//A renderer has a handful of materials, a search is cheaper than keeping a second map in sync
+	for (MaterialHandle handle = 0; handle < m_Materials.size(); ++handle)
+	{
+		if (m_Materials[handle].nrReferences > 0 && m_Materials[handle].diffusePath == diffusePath)
+		{
+			AddReference(handle);
+			return handle;
+		}
+	}
+	return CreateMaterial(diffusePath);
+}
+
+void MaterialCache::AddReference(MaterialHandle handle)
+{
+	assert(m_Materials[handle].nrReferences > 0 && "Material was already released");
+	++m_Materials[handle].nrReferences;
+}
+
+void MaterialCache::Release(MaterialHandle handle)
+{
+	MaterialEntry& entry = m_Materials[handle];
+	assert(entry.nrReferences > 0 && "Material was already released");
+	if (--entry.nrReferences > 0)
+	{
+		return;
+	}
+
+	ReleaseTexture(entry.diffusePath);
+	entry = MaterialEntry{};
+	m_FreeMaterials.push_back(handle);
+}
+
+const Texture* MaterialCache::AcquireTexture(const std::string& path)
+{
+	//A path that failed to load stays in the cache as well, so it isn't tried again for every material
+	auto [it, isNew] = m_Textures.try_emplace(path);
+	if (isNew)
+	{
+		it->second.pTexture = Texture::LoadFromFile(path);
+	}
+
+	++it->second.nrReferences;
+	return it->second.pTexture;
+}
+
+void MaterialCache::ReleaseTexture(const std::string& path)
+{
+	const auto it = m_Textures.find(path);
+	if (--it->second.nrReferences == 0)
+	{
+		delete it->second.pTexture;
+		m_Textures.erase(it);
+	}
+}
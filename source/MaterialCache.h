@@ -0,0 +1,69 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Project includes
+#include "DataTypes.h"
+
+namespace dae
+{
+	class Texture;
+
+	struct Material
+	{
+		//nullptr when the image couldn't be loaded, the surface is shaded white then
+		const Texture* pDiffuse{ nullptr };
+	};
+
+	//Owns every material and texture of a renderer. Textures are loaded once per path and shared by all materials that use them
+	//Materials and textures are reference counted, both are freed when their last reference is released
+	class MaterialCache final
+	{
+	public:
+		MaterialCache() = default;
+		~MaterialCache();
+
+		MaterialCache(const MaterialCache&) = delete;
+		MaterialCache(MaterialCache&&) noexcept = delete;
+		MaterialCache& operator=(const MaterialCache&) = delete;
+		MaterialCache& operator=(MaterialCache&&) noexcept = delete;
+
+		//Returns a material with one reference, the texture is only loaded when no other material uses it yet
+		MaterialHandle CreateMaterial(const std::string& diffusePath);
+		//Returns the material that already uses this path with one more reference, or creates it when there is none
+		MaterialHandle AcquireMaterial(const std::string& diffusePath);
+		//For every mesh that shares the material besides the one it was created for
+		void AddReference(MaterialHandle handle);
+		void Release(MaterialHandle handle);
+
+		const Material& GetMaterial(MaterialHandle handle) const { return m_Materials[handle].material; }
+		size_t GetTextureCount() const { return m_Textures.size(); }
+
+	private:
+		struct TextureEntry
+		{
+			Texture* pTexture{ nullptr };
+			uint32_t nrReferences{};
+		};
+
+		struct MaterialEntry
+		{
+			Material material{};
+			//Key of the texture in m_Textures
+			std::string diffusePath{};
+			uint32_t nrReferences{};
+		};
+
+		std::unordered_map<std::string, TextureEntry> m_Textures{};
+		//A handle is an index, released slots are reused so the handles of other materials stay valid
+		std::vector<MaterialEntry> m_Materials{};
+		std::vector<MaterialHandle> m_FreeMaterials{};
+
+		const Texture* AcquireTexture(const std::string& path);
+		void ReleaseTexture(const std::string& path);
+	};
+}
@@ -0,0 +1,30 @@
+//Standard includes
+#include <algorithm>
+
+//Project includes
+#include "MemoryRenderTarget.h"
+
+using namespace dae;
+
+MemoryRenderTarget::MemoryRenderTarget(int width, int height, uint32_t* pPixels)
+	: m_Width{ width }
+	, m_Height{ height }
+	, m_pPixels{ pPixels }
+{
+}
+
+uint64_t MemoryRenderTarget::Present(const PixelSpan& frame)
+{
+	//The caller's buffer is tightly packed, the frame's rows can be further apart
+	m_pLastFramePixels = frame.pPixels;
+	if (m_pPixels)
+	{
+		for (int y = 0; y < m_Height; ++y)
+		{
+			const uint32_t* pRow = reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(frame.pPixels) + y * frame.pitch);
+			std::copy_n(pRow, m_Width, m_pPixels + y * m_Width);
+		}
+	}
+
+	return ++m_LastFence;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+//Project includes
+#include "RenderTarget.h"
+
+namespace dae
+{
+	//Render target without a window, so no video subsystem is needed
+	//Frames are kept where they were rendered, or copied to a buffer of the caller
+	class MemoryRenderTarget final : public RenderTarget
+	{
+	public:
+		//pPixels is optional and has to hold width * height pixels, they are written in the format of the frame
+		MemoryRenderTarget(int width, int height, uint32_t* pPixels = nullptr);
+		~MemoryRenderTarget() override = default;
+
+		int GetWidth() const override { return m_Width; }
+		int GetHeight() const override { return m_Height; }
+
+		//Nothing runs in the background, every fence is reached when Present returns
+		uint64_t Present(const PixelSpan& frame) override;
+		void WaitForFence(uint64_t) override {}
+
+		//Last presented frame, without a buffer of the caller it stays valid until the renderer reuses its back buffer
+		const uint32_t* GetPixels() const { return m_pPixels ? m_pPixels : m_pLastFramePixels; }
+
+	private:
+		int m_Width{};
+		int m_Height{};
+
+		uint32_t* m_pPixels{ nullptr };
+		const uint32_t* m_pLastFramePixels{ nullptr };
+		uint64_t m_LastFence{};
+	};
+}
@@ -0,0 +1,140 @@
+//External includes
+#include "SDL.h"
+#include "SDL_surface.h"
+
+//Project includes
+#include "Presenter.h"
+
+using namespace dae;
+
+namespace
+{
+	Uint32 ToSDLFormat(PixelFormat format)
+	{
+		switch (format)
+		{
+		case PixelFormat::XRGB8888:
+		default:
+			//SDL's RGB888 has the unused byte on top
+			return SDL_PIXELFORMAT_RGB888;
+		}
+	}
+}
+
+Presenter::Presenter(SDL_Window* pWindow)
+	: m_pWindow{ pWindow }
+{
+	//The window surface is fetched here, on the thread that owns the window
+	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
+	SDL_GetWindowSize(pWindow, &m_Width, &m_Height);
+
+	m_Thread = std::thread{ &Presenter::CopyLoop, this };
+}
+
+Presenter::~Presenter()
+{
+	//Frames that are still queued get presented first
+	{
+		std::unique_lock<std::mutex> lock{ m_Mutex };
+		while (m_ShownFence < m_LastFence)
+		{
+			if (m_ShownFence < m_CopiedFence)
+			{
+				ShowCopiedFrame(lock);
+				continue;
+			}
+			m_FenceCondition.wait(lock);
+		}
+		m_IsStopping = true;
+	}
+	m_FrameCondition.notify_one();
+
+	m_Thread.join();
+}
+
+uint64_t Presenter::Present(const PixelSpan& frame)
+{
+	uint64_t fence{};
+	{
+		std::unique_lock<std::mutex> lock{ m_Mutex };
+		if (m_ShownFence < m_CopiedFence)
+		{
+			ShowCopiedFrame(lock);
+		}
+
+		while (m_NrFrames == MAX_QUEUED_FRAMES)
+		{
+			if (m_ShownFence < m_CopiedFence)
+			{
+				ShowCopiedFrame(lock);
+				continue;
+			}
+			m_FenceCondition.wait(lock);
+		}
+
+		fence = ++m_LastFence;
+		m_Frames[(m_FirstFrame + m_NrFrames) % MAX_QUEUED_FRAMES] = { frame, fence };
+		++m_NrFrames;
+	}
+	m_FrameCondition.notify_one();
+
+	return fence;
+}
+
+void Presenter::WaitForFence(uint64_t fence)
+{
+	std::unique_lock<std::mutex> lock{ m_Mutex };
+	while (m_CopiedFence < fence)
+	{
+		//The copy thread waits for its last copy to be on the window before it writes the surface again
+		if (m_ShownFence < m_CopiedFence)
+		{
+			ShowCopiedFrame(lock);
+			continue;
+		}
+		m_FenceCondition.wait(lock);
+	}
+}
+
+void Presenter::ShowCopiedFrame(std::unique_lock<std::mutex>& lock)
+{
+	const uint64_t fence = m_CopiedFence;
+	lock.unlock();
+	SDL_UpdateWindowSurface(m_pWindow);
+	lock.lock();
+
+	m_ShownFence = fence;
+	m_FrameCondition.notify_one();
+}
+
+void Presenter::CopyLoop()
+{
+	while (true)
+	{
+		Frame frame{};
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_FrameCondition.wait(lock, [this]() { return m_IsStopping || (m_NrFrames > 0 && m_ShownFence == m_CopiedFence); });
+			if (m_NrFrames == 0)
+			{
+				return;
+			}
+
+			frame = m_Frames[m_FirstFrame];
+			m_FirstFrame = (m_FirstFrame + 1) % MAX_QUEUED_FRAMES;
+			--m_NrFrames;
+		}
+
+		//Update SDL Surface, converted if the window doesn't use the format of the frame
+		//Only the pixels are touched here, no window call
+		const PixelSpan& pixels = frame.pixels;
+		SDL_ConvertPixels(pixels.width, pixels.height, ToSDLFormat(pixels.format), pixels.pPixels, pixels.pitch,
+			m_pFrontBuffer->format->format, m_pFrontBuffer->pixels, m_pFrontBuffer->pitch);
+
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			m_CopiedFence = frame.fence;
+		}
+		m_FenceCondition.notify_all();
+	}
+}
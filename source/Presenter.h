@@ -0,0 +1,70 @@
+#pragma once
+
+//Standard includes
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+//Project includes
+#include "RenderTarget.h"
+
+struct SDL_Window;
+struct SDL_Surface;
+
+namespace dae
+{
+	//Copies finished frames to the window surface on its own thread, so the next frame can be rasterized meanwhile
+	//SDL only allows window calls from the thread that created the window, so the copy is put on the window by the caller's thread
+	class Presenter final : public RenderTarget
+	{
+	public:
+		Presenter(SDL_Window* pWindow);
+		~Presenter() override;
+
+		int GetWidth() const override { return m_Width; }
+		int GetHeight() const override { return m_Height; }
+
+		//Puts the last finished copy on the window, then queues the frame and returns its fence
+		//The frame can't be written to until the fence is reached, blocks while MAX_QUEUED_FRAMES frames are already waiting
+		uint64_t Present(const PixelSpan& frame) override;
+
+		//Blocks until every frame up to and including fence is copied, puts copies on the window while it waits
+		void WaitForFence(uint64_t fence) override;
+
+	private:
+		struct Frame
+		{
+			PixelSpan pixels{};
+			uint64_t fence{};
+		};
+
+		//As many as the renderer has back buffers, it never has more frames in flight
+		static constexpr int MAX_QUEUED_FRAMES{ 3 };
+
+		SDL_Window* m_pWindow{};
+		SDL_Surface* m_pFrontBuffer{ nullptr };
+		int m_Width{};
+		int m_Height{};
+
+		std::thread m_Thread{};
+		std::mutex m_Mutex{};
+		std::condition_variable m_FrameCondition{};
+		std::condition_variable m_FenceCondition{};
+
+		//Ring of the frames waiting to be copied, fixed so presenting never allocates
+		Frame m_Frames[MAX_QUEUED_FRAMES]{};
+		int m_FirstFrame{};
+		int m_NrFrames{};
+		uint64_t m_LastFence{};
+		//Last frame copied to the window surface, its back buffer can be reused
+		uint64_t m_CopiedFence{};
+		//Last frame put on the window, the surface isn't written again until it matches m_CopiedFence
+		uint64_t m_ShownFence{};
+		bool m_IsStopping{ false };
+
+		void CopyLoop();
+		//Puts the last copy on the window, unlocks while SDL updates it
+		void ShowCopiedFrame(std::unique_lock<std::mutex>& lock);
+	};
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+//Standard includes
+#include <cstdint>
+
+namespace dae
+{
+	//Layout of a 32 bit pixel
+	enum class PixelFormat
+	{
+		//Blue in the lowest byte, then green and red, the highest byte is unused
+		XRGB8888
+	};
+
+	//A finished frame in plain memory, so render targets don't have to know how the renderer allocates it
+	struct PixelSpan
+	{
+		const uint32_t* pPixels{ nullptr };
+		int width{};
+		int height{};
+		//Bytes from the start of one row to the next
+		int pitch{};
+		PixelFormat format{ PixelFormat::XRGB8888 };
+	};
+
+	//Where the renderer sends finished frames, a window or plain memory
+	//Presenting can finish later, the pixels of a frame can't be written to until the fence Present returned is reached
+	class RenderTarget
+	{
+	public:
+		RenderTarget() = default;
+		virtual ~RenderTarget() = default;
+
+		RenderTarget(const RenderTarget&) = delete;
+		RenderTarget(RenderTarget&&) noexcept = delete;
+		RenderTarget& operator=(const RenderTarget&) = delete;
+		RenderTarget& operator=(RenderTarget&&) noexcept = delete;
+
+		virtual int GetWidth() const = 0;
+		virtual int GetHeight() const = 0;
+
+		virtual uint64_t Present(const PixelSpan& frame) = 0;
+		virtual void WaitForFence(uint64_t fence) = 0;
+	};
+}
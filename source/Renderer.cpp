@@ -6,137 +6,245 @@
 #include "Renderer.h"
 #include "Math.h"
 #include "Matrix.h"
+#include "RenderTarget.h"
+#include "SIMD.h"
 #include "Texture.h"
+#include "ThreadPool.h"
 #include "Utils.h"
 
-#include <future>
-#include <ppl.h>
+#include <bit>
+#include <iostream>
 
 //#define STRIP
 
 using namespace dae;
 
-Renderer::Renderer(SDL_Window* pWindow)
-	:m_pWindow(pWindow)
-	, m_pTexture{ Texture::LoadFromFile("Resources/tuktuk.png") }
+Renderer::Renderer(RenderTarget* pRenderTarget, uint32_t nrThreads)
+	:m_pRenderTarget(pRenderTarget)
 {
 	//Initialize
-	SDL_GetWindowSize(pWindow, &m_Width, &m_Height);
+	m_Width = pRenderTarget->GetWidth();
+	m_Height = pRenderTarget->GetHeight();
+	m_RenderWidth = m_Width;
+	m_RenderHeight = m_Height;
 
 	//Create Buffers
-	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
-	m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
-	m_pBackBufferPixels = (uint32_t*)m_pBackBuffer->pixels;
+	for (uint32_t*& pBackBuffer : m_pBackBuffers)
+	{
+		pBackBuffer = new uint32_t[m_Width * m_Height]{};
+	}
+	m_pBackBufferPixels = m_pBackBuffers[0];
+
+	//The back buffers are PixelFormat::XRGB8888, 8 bits per channel, so no precision loss has to be applied
+	m_RedShift = 16;
+	m_GreenShift = 8;
+	m_BlueShift = 0;
+	m_AlphaMask = 0;
+	m_ClearColor = 100u << m_RedShift | 100u << m_GreenShift | 100u << m_BlueShift;
+
+	//Create workers and the tiles they rasterize
+	m_pThreadPool = nrThreads > 0 ? new ThreadPool(nrThreads) : new ThreadPool();
+	CreateTiles();
 
-	m_pDepthBufferPixels = new float[m_Width * m_Height];
+	//Every buffer is sized for the full window, a lower render resolution uses the start of it
+	//Swizzled buffers store the tiles on the edges of the screen as full tiles
+	const int bufferSize{ std::max(m_TilesX * m_TilesY * TILE_SIZE * TILE_SIZE, m_Width * m_Height) };
+	m_pSwizzledColorBufferPixels = new uint32_t[bufferSize];
+	m_pScaledColorBufferPixels = new uint32_t[m_Width * m_Height];
+	m_DepthBufferSize = bufferSize;
+	CreateDepthBuffer();
+
+	m_HiZWidth = (m_Width + HIZ_BLOCK_SIZE - 1) / HIZ_BLOCK_SIZE;
+	m_HiZHeight = (m_Height + HIZ_BLOCK_SIZE - 1) / HIZ_BLOCK_SIZE;
+	m_pHiZBufferPixels = new float[m_HiZWidth * m_HiZHeight];
+
+	m_pVisibilityBufferPixels = new uint32_t[bufferSize];
+
+	m_UpscaleColumns.resize(m_Width);
 
 	//Initialize Camera
 	m_AspectRatio = (float)m_Width / (float)m_Height;
 	m_Camera.Initialize(m_AspectRatio,60.f, { .0f,.0f,-10.f });
 
 	//CreateMeshes();
-	LoadMesh("Resources/tuktuk.obj");
+	LoadMesh("Resources/tuktuk.obj", "Resources/tuktuk.png");
 	//m_MeshesWorld.push_back(Mesh{ {},{}, PrimitiveTopology::TriangleList });
 	//Utils::ParseOBJ("Resources/tuktuk.obj", m_MeshesWorld[0].vertices, m_MeshesWorld[0].indices);
 	//m_MeshesWorld[0].worldMatrix = Matrix::CreateScale({ 0.5f,0.5f,0.5f }) * Matrix::CreateTranslation(0.f, -3.f, 15.f);
 
-	//Reserve max size
-	const int reserveSize = FindReserveSize();
-	m_VerticesCount = reserveSize;
-	m_VerticesNDC = new Vertex[reserveSize];
-	m_VerticesWorld = new Vertex[reserveSize];
-	m_VerticesScreenSpace = new Vector2[reserveSize];
+	for (Mesh& mesh : m_MeshesWorld)
+	{
+		CreateVertexStreams(mesh);
+		mesh.bounds = Utils::CalculateBounds(mesh.vertices);
+		m_InitialWorldMatrices.push_back(mesh.worldMatrix);
+	}
 }
 
 Renderer::~Renderer()
 {
+	//The render target can still be reading the buffers of queued frames
+	for (int i = 0; i < BACK_BUFFER_COUNT; ++i)
+	{
+		m_pRenderTarget->WaitForFence(m_BackBufferFences[i]);
+		delete[] m_pBackBuffers[i];
+	}
+
+	delete m_pThreadPool;
 	delete[] m_pDepthBufferPixels;
-	delete[] m_VerticesNDC;
-	delete[] m_VerticesWorld;
-	delete[] m_VerticesScreenSpace;
-	delete m_pTexture;
+	delete[] m_pDepth16BufferPixels;
+	delete[] m_pDepth24BufferPixels;
+	delete[] m_pHiZBufferPixels;
+	delete[] m_pVisibilityBufferPixels;
+	delete[] m_pSwizzledColorBufferPixels;
+	delete[] m_pScaledColorBufferPixels;
+	delete[] m_pSampleRecordIndices;
+
+	for (const Mesh& mesh : m_MeshesWorld)
+	{
+		if (mesh.material != INVALID_MATERIAL)
+		{
+			m_MaterialCache.Release(mesh.material);
+		}
+	}
 }
 
 void Renderer::Update(Timer* pTimer)
 {
 	m_Camera.Update(pTimer);
+	UpdateResolutionScale(pTimer->GetElapsed());
 
-	const float rotationSpeed = 1.f;
 	for (Mesh& mesh : m_MeshesWorld)
 	{
-		mesh.worldMatrix = Matrix::CreateRotationY((rotationSpeed * pTimer->GetElapsed())) * mesh.worldMatrix;
+		mesh.worldMatrix = Matrix::CreateRotationY((MESH_ROTATION_SPEED * pTimer->GetElapsed())) * mesh.worldMatrix;
+	}
+}
+
+void Renderer::SetSceneTime(float seconds)
+{
+	//Rotating from the start instead of per frame keeps every frame independent of the ones before
+	const Matrix rotation = Matrix::CreateRotationY(MESH_ROTATION_SPEED * seconds);
+	for (size_t i = 0; i < m_MeshesWorld.size(); ++i)
+	{
+		m_MeshesWorld[i].worldMatrix = rotation * m_InitialWorldMatrices[i];
 	}
 }
 
+void Renderer::SetCameraPose(const Vector3& origin, float pitch, float yaw)
+{
+	m_Camera.SetPose(origin, pitch, yaw);
+}
+
 void Renderer::Render()
 {
 	//@START
-	//Clears background
-	SDL_FillRect(m_pBackBuffer, NULL, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
-	//Lock BackBuffer
-	SDL_LockSurface(m_pBackBuffer);
+	//The buffer of this frame could still be on its way to the window
+	m_pRenderTarget->WaitForFence(m_BackBufferFences[m_BackBufferIndex]);
+	m_pBackBufferPixels = m_pBackBuffers[m_BackBufferIndex];
+	const bool isScaled = m_RenderWidth != m_Width || m_RenderHeight != m_Height;
+	m_pRenderTargetPixels = isScaled ? m_pScaledColorBufferPixels : m_pBackBufferPixels;
+	m_pColorBufferPixels = m_IsSwizzledLayout ? m_pSwizzledColorBufferPixels : m_pRenderTargetPixels;
+
+	//Buffers are cleared per tile, by the first triangle that is drawn in it
+	for (Tile& tile : m_Tiles)
+	{
+		tile.isCleared = false;
+	}
 
-	const int nrPixels{ m_Width * m_Height };
-	std::fill_n(m_pDepthBufferPixels, nrPixels, FLT_MAX);
+	//Everything of the previous frame is released at once
+	m_FrameArena.Reset();
+	m_TriangleSetups.Reset(m_FrameArena);
 
 	//Loop over every mesh
 	for (Mesh& mesh : m_MeshesWorld)
 	{
-		//Create vertices from indices
-		for (size_t i = 0; i < mesh.indices.size(); ++i)
+		if (!IsMeshInFrustum(mesh))
 		{
-			m_VerticesWorld[i] = mesh.vertices[mesh.indices[i]];
+			continue;
 		}
 
-		//Set maximum read count
-		m_VerticesCount = mesh.indices.size();
+		//Shared vertices are only transformed once
+		VertexTransformationWorldToScreen(mesh);
 
-		//VertexTransformationWorldToNDC();
-		VertexTransformationWorldToNDCNew(mesh);
-
-		//Convert ndc's to screenspace
-		//for (size_t i = 0; i < m_VerticesCount; i++)
-		//{
-		//	Vector2 temp{};
-		//	temp.x = (m_VerticesNDC[i].position.x + 1) / 2 * m_Width;
-		//	temp.y = (1 - m_VerticesNDC[i].position.y) / 2 * m_Height;
-		//	m_VerticesScreenSpace[i] = temp;
-		//}
-		for (size_t i = 0; i < m_VerticesCount; i++)
-		{
-			Vector2 temp{};
-			temp.x = (mesh.vertices_out[i].position.x + 1) / 2 * m_Width;
-			temp.y = (1 - mesh.vertices_out[i].position.y) / 2 * m_Height;
-			m_VerticesScreenSpace[i] = temp;
-		}
+		//Build the triangle list, clipping adds vertices to the end of vertices_out
+		AssembleTriangles(mesh);
+		SetupTriangles(mesh);
+	}
 
+	//RENDER LOGIC
+	BinTriangles();
 
-		//RENDER LOGIC
-		switch (mesh.primitiveTopology)
+	//Tiles never share pixels, so the workers can write to the buffers without locking
+	m_pThreadPool->ParallelFor(static_cast<uint32_t>(m_Tiles.size()), [&](uint32_t tileIndex)
 		{
-		case PrimitiveTopology::TriangleList:
+			RasterizeTile(m_Tiles[tileIndex]);
+		});
+
+	//Tiles that ran out of sample records are drawn again with the larger pool they asked for
+	//The pools come from the arena, so they can only grow in between the parallel passes
+	if (IsCoverageAA())
+	{
+		ArenaVector<uint32_t> redrawnTiles{};
+		redrawnTiles.Reset(m_FrameArena);
+		while (true)
 		{
-			for (int i = 0; i < m_VerticesCount; i += 3)
+			redrawnTiles.clear();
+			for (uint32_t i = 0; i < static_cast<uint32_t>(m_Tiles.size()); ++i)
 			{
-				DrawTriangle(i, false, mesh);
+				Tile& tile = m_Tiles[i];
+				if (tile.nrSampleRecordsNeeded > tile.nrSampleRecords)
+				{
+					tile.pSampleRecords = m_FrameArena.Allocate<SampleRecord>(tile.sampleRecordCapacity);
+					redrawnTiles.push_back(i);
+				}
+			}
+			if (redrawnTiles.empty())
+			{
+				break;
 			}
+
+			m_pThreadPool->ParallelFor(static_cast<uint32_t>(redrawnTiles.size()), [&](uint32_t i)
+				{
+					RasterizeTile(m_Tiles[redrawnTiles[i]]);
+				});
 		}
-		break;
-		case PrimitiveTopology::TriangleStrip:
+	}
+
+	//Clears background of the untouched tiles
+	//Deferred shading of the others, every visible pixel is shaded exactly once
+	m_pThreadPool->ParallelFor(static_cast<uint32_t>(m_Tiles.size()), [&](uint32_t tileIndex)
 		{
-			for (int i = 0; i < m_VerticesCount - 2; ++i)
+			const Tile& tile = m_Tiles[tileIndex];
+			if (!tile.isCleared)
 			{
-				DrawTriangle(i, i % 2, mesh);
+				FillTile(tile);
+				return;
 			}
-		}
-		break;
-		}
+
+			if (m_IsVisibilityBuffer)
+			{
+				ResolveTile(tile);
+			}
+			if (m_IsSwizzledLayout)
+			{
+				DetileTile(tile);
+			}
+		});
+
+	//Stretch the frame over the window, in bands of rows
+	if (isScaled)
+	{
+		const uint32_t nrBands = static_cast<uint32_t>((m_Height + TILE_SIZE - 1) / TILE_SIZE);
+		m_pThreadPool->ParallelFor(nrBands, [&](uint32_t band)
+			{
+				UpscaleRows(band * TILE_SIZE, std::min((band + 1) * TILE_SIZE, static_cast<uint32_t>(m_Height)));
+			});
 	}
 	//@END
-	//Update SDL Surface
-	SDL_UnlockSurface(m_pBackBuffer);
-	SDL_BlitSurface(m_pBackBuffer, 0, m_pFrontBuffer, 0);
-	SDL_UpdateWindowSurface(m_pWindow);
+
+	//Presenting can finish later, the next frame goes to the next buffer
+	const PixelSpan frame{ m_pBackBufferPixels, m_Width, m_Height, m_Width * static_cast<int>(sizeof(uint32_t)), PixelFormat::XRGB8888 };
+	m_BackBufferFences[m_BackBufferIndex] = m_pRenderTarget->Present(frame);
+	m_BackBufferIndex = (m_BackBufferIndex + 1) % BACK_BUFFER_COUNT;
 }
 
 void dae::Renderer::ToggleDepthBuffer()
@@ -144,6 +252,141 @@ void dae::Renderer::ToggleDepthBuffer()
 	m_IsDepthBuffer = !m_IsDepthBuffer;
 }
 
+const Texture* dae::Renderer::GetDiffuseTexture(MaterialHandle material) const
+{
+	return material == INVALID_MATERIAL ? nullptr : m_MaterialCache.GetMaterial(material).pDiffuse;
+}
+
+void dae::Renderer::ToggleTextureFilter()
+{
+	m_Sampler.filter = m_Sampler.filter == TextureFilter::Bilinear ? TextureFilter::Point : TextureFilter::Bilinear;
+}
+
+void dae::Renderer::SetSampler(const Sampler& sampler)
+{
+	m_Sampler = sampler;
+}
+
+void dae::Renderer::ToggleVisibilityBuffer()
+{
+	m_IsVisibilityBuffer = !m_IsVisibilityBuffer;
+}
+
+void dae::Renderer::ToggleSwizzledLayout()
+{
+	m_IsSwizzledLayout = !m_IsSwizzledLayout;
+}
+
+void dae::Renderer::ToggleDynamicResolution()
+{
+	m_IsDynamicResolution = !m_IsDynamicResolution;
+	m_ResolutionScale = 1.f;
+	m_AverageFrameTime = m_TargetFrameTime;
+	SetRenderResolution(m_Width, m_Height);
+}
+
+void dae::Renderer::SetTargetFrameTime(float seconds)
+{
+	m_TargetFrameTime = seconds;
+}
+
+void dae::Renderer::UpdateResolutionScale(float frameTime)
+{
+	if (!m_IsDynamicResolution || frameTime <= 0.f)
+	{
+		return;
+	}
+
+	//Smooth out single slow frames, the cost of a frame is assumed to grow with the number of pixels
+	m_AverageFrameTime += (frameTime - m_AverageFrameTime) * FRAME_TIME_SMOOTHING;
+	const float desiredScale = m_ResolutionScale * std::sqrt(m_TargetFrameTime / m_AverageFrameTime);
+
+	//Only move part of the way, the average lags behind and would make the scale overshoot
+	m_ResolutionScale += (desiredScale - m_ResolutionScale) * RESOLUTION_SCALE_RESPONSE;
+	m_ResolutionScale = std::clamp(m_ResolutionScale, MIN_RESOLUTION_SCALE, 1.f);
+
+	//Sizes are kept to whole Hi-Z blocks, so small changes of the scale don't resize every frame
+	if (m_ResolutionScale >= 1.f)
+	{
+		SetRenderResolution(m_Width, m_Height);
+		return;
+	}
+	const auto scaleSize = [&](int size)
+		{
+			const int blocks = static_cast<int>(std::lround(size * m_ResolutionScale / HIZ_BLOCK_SIZE));
+			return std::clamp(blocks * HIZ_BLOCK_SIZE, HIZ_BLOCK_SIZE, size);
+		};
+	SetRenderResolution(scaleSize(m_Width), scaleSize(m_Height));
+}
+
+void dae::Renderer::SetRenderResolution(int width, int height)
+{
+	if (width == m_RenderWidth && height == m_RenderHeight)
+	{
+		return;
+	}
+
+	m_RenderWidth = width;
+	m_RenderHeight = height;
+
+	//Everything is sized for the full window, so nothing is allocated here
+	CreateTiles();
+	m_HiZWidth = (m_RenderWidth + HIZ_BLOCK_SIZE - 1) / HIZ_BLOCK_SIZE;
+	m_HiZHeight = (m_RenderHeight + HIZ_BLOCK_SIZE - 1) / HIZ_BLOCK_SIZE;
+
+	//Nearest pixel of the render target for every column of the window
+	for (int x = 0; x < m_Width; ++x)
+	{
+		m_UpscaleColumns[x] = static_cast<uint32_t>((2 * x + 1) * m_RenderWidth / (2 * m_Width));
+	}
+}
+
+void dae::Renderer::CycleSampleCount()
+{
+	m_SampleCount = m_SampleCount == 1 ? 4 : m_SampleCount == 4 ? 8 : 1;
+
+	//The records themselves come from the frame arena, per tile
+	if (m_SampleCount > 1 && !m_pSampleRecordIndices)
+	{
+		m_pSampleRecordIndices = new uint32_t[m_DepthBufferSize];
+	}
+}
+
+void dae::Renderer::SetDepthFormat(DepthFormat format)
+{
+	m_DepthFormat = format;
+	CreateDepthBuffer();
+}
+
+void dae::Renderer::CycleDepthFormat()
+{
+	SetDepthFormat(static_cast<DepthFormat>((static_cast<int>(m_DepthFormat) + 1) % (static_cast<int>(DepthFormat::ReversedFloat32) + 1)));
+}
+
+void dae::Renderer::CreateDepthBuffer()
+{
+	delete[] m_pDepthBufferPixels;
+	delete[] m_pDepth16BufferPixels;
+	delete[] m_pDepth24BufferPixels;
+	m_pDepthBufferPixels = nullptr;
+	m_pDepth16BufferPixels = nullptr;
+	m_pDepth24BufferPixels = nullptr;
+
+	//Every tile clears its part before the first triangle is drawn, so the contents don't matter
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::Unorm16:
+		m_pDepth16BufferPixels = new uint16_t[m_DepthBufferSize];
+		break;
+	case DepthFormat::Fixed24:
+		m_pDepth24BufferPixels = new uint32_t[m_DepthBufferSize];
+		break;
+	default:
+		m_pDepthBufferPixels = new float[m_DepthBufferSize];
+		break;
+	}
+}
+
 void dae::Renderer::CreateMeshes()
 {
 #ifdef STRIP
@@ -195,13 +438,22 @@ void dae::Renderer::CreateMeshes()
 #endif
 }
 
-void Renderer::LoadMesh(const std::string& path)
+void Renderer::LoadMesh(const std::string& path, const std::string& diffusePath)
 {
 	//Create empty mesh
 	m_MeshesWorld.push_back(Mesh{ {},{}, PrimitiveTopology::TriangleList });
+	//Meshes with the same texture share its material
+	m_MeshesWorld.back().material = m_MaterialCache.AcquireMaterial(diffusePath);
+	if (!GetDiffuseTexture(m_MeshesWorld.back().material))
+	{
+		std::cout << "Texture " << diffusePath << " could not be loaded, the mesh is shaded white!" << std::endl;
+	}
 
 	//Load mesh
-	Utils::ParseOBJ(path, m_MeshesWorld[m_MeshesWorld.size()-1].vertices, m_MeshesWorld[m_MeshesWorld.size() - 1].indices);
+	if (!Utils::ParseOBJ(path, m_MeshesWorld[m_MeshesWorld.size()-1].vertices, m_MeshesWorld[m_MeshesWorld.size() - 1].indices))
+	{
+		std::cout << "Mesh " << path << " could not be loaded!" << std::endl;
+	}
 
 	//Set values for matrix
 	const Vector3 translation = { m_Camera.origin + Vector3{ 0.0f, -3.f, 15.f } };
@@ -212,215 +464,1415 @@ void Renderer::LoadMesh(const std::string& path)
 	m_MeshesWorld[m_MeshesWorld.size() - 1].worldMatrix = Matrix::CreateScale(scale) * Matrix::CreateRotation(rotation) * Matrix::CreateTranslation(translation);
 }
 
-void Renderer::VertexTransformationWorldToNDC()
+bool dae::Renderer::IsMeshInFrustum(const Mesh& mesh) const
 {
-	Vertex v{};
-	for (int i = 0; i < m_VerticesCount; i++)
+	const Bounds& bounds = mesh.bounds;
+	const Matrix& world = mesh.worldMatrix;
+
+	//Box center and half size in world space, the rotated box is wrapped in a new axis aligned one
+	const Vector3 center = world.TransformPoint(bounds.center);
+	const Vector3 halfSize = (bounds.max - bounds.min) * 0.5f;
+	const Vector3 axisX = world.GetAxisX(), axisY = world.GetAxisY(), axisZ = world.GetAxisZ();
+	const Vector3 worldHalfSize
 	{
-		v = m_VerticesWorld[i];
+		std::abs(axisX.x) * halfSize.x + std::abs(axisY.x) * halfSize.y + std::abs(axisZ.x) * halfSize.z,
+		std::abs(axisX.y) * halfSize.x + std::abs(axisY.y) * halfSize.y + std::abs(axisZ.y) * halfSize.z,
+		std::abs(axisX.z) * halfSize.x + std::abs(axisY.z) * halfSize.y + std::abs(axisZ.z) * halfSize.z
+	};
+	const float radius = bounds.radius * std::max(axisX.Magnitude(), std::max(axisY.Magnitude(), axisZ.Magnitude()));
+
+	for (const Vector4& plane : m_Camera.frustumPlanes)
+	{
+		const Vector3 normal{ plane.x, plane.y, plane.z };
+		const float distance = Vector3::Dot(normal, center) + plane.w;
+
+		//Sphere first, it's the cheaper test
+		if (distance < -radius)
+		{
+			return false;
+		}
 
-		//Transfrom to camera matrix
-		v.position = m_Camera.invViewMatrix.TransformPoint(v.position);
+		//Corner of the box that is the farthest along the normal
+		const float extent = std::abs(normal.x) * worldHalfSize.x + std::abs(normal.y) * worldHalfSize.y + std::abs(normal.z) * worldHalfSize.z;
+		if (distance < -extent)
+		{
+			return false;
+		}
+	}
+	return true;
+}
 
-		//Perspective devide
-		v.position.x = v.position.x / (m_AspectRatio * m_Camera.fov) / v.position.z;
-		v.position.y = v.position.y / m_Camera.fov / v.position.z;
+void dae::Renderer::CreateVertexStreams(Mesh& mesh)
+{
+	VertexStreams& streams = mesh.vertexStreams;
+	const size_t nrVertices = mesh.vertices.size();
+	streams.positionX.resize(nrVertices);
+	streams.positionY.resize(nrVertices);
+	streams.positionZ.resize(nrVertices);
+	streams.u.resize(nrVertices);
+	streams.v.resize(nrVertices);
 
-		m_VerticesNDC[i] = v;
+	for (size_t i = 0; i < nrVertices; ++i)
+	{
+		streams.positionX[i] = mesh.vertices[i].position.x;
+		streams.positionY[i] = mesh.vertices[i].position.y;
+		streams.positionZ[i] = mesh.vertices[i].position.z;
+		streams.u[i] = mesh.vertices[i].uv.x;
+		streams.v[i] = mesh.vertices[i].uv.y;
 	}
 }
 
-void dae::Renderer::VertexTransformationWorldToNDCNew(Mesh& mesh)
+void dae::Renderer::VertexTransformationWorldToScreen(Mesh& mesh)
 {
+	using namespace simd;
+
 	const Matrix matrix = mesh.worldMatrix * m_Camera.viewMatrix * m_Camera.projectionMatrix;
 
-	Vertex_Out v{};
-	mesh.vertices_out.clear();
-	mesh.vertices_out.reserve(m_VerticesCount);
-	for (int i = 0; i < m_VerticesCount; i++)
+	const VertexStreams& in = mesh.vertexStreams;
+	VertexStreams_Out& out = mesh.vertices_out;
+	const size_t nrVertices = in.positionX.size();
+	out.Reset(m_FrameArena);
+	out.positionX.resize(nrVertices);
+	out.positionY.resize(nrVertices);
+	out.positionZ.resize(nrVertices);
+	out.positionW.resize(nrVertices);
+	out.screenX.resize(nrVertices);
+	out.screenY.resize(nrVertices);
+	out.u.assign(in.u.begin(), in.u.end());
+	out.v.assign(in.v.begin(), in.v.end());
+
+	//Every matrix element in all lanes, row r is multiplied with component r of the point
+	FloatV matrixV[4][4];
+	for (int row = 0; row < 4; ++row)
+	{
+		for (int column = 0; column < 4; ++column)
+		{
+			matrixV[row][column] = Set1(matrix[row][column]);
+		}
+	}
+	const auto transform = [&](FloatV x, FloatV y, FloatV z, int column)
+		{
+			return Add(Add(Add(Mul(matrixV[0][column], x), Mul(matrixV[1][column], y)), Mul(matrixV[2][column], z)), matrixV[3][column]);
+		};
+
+	const FloatV oneV = Set1(1.f);
+	const FloatV halfV = Set1(0.5f);
+	const FloatV widthV = Set1(static_cast<float>(m_RenderWidth));
+	const FloatV heightV = Set1(static_cast<float>(m_RenderHeight));
+
+	for (size_t i = 0; i < nrVertices; i += LANES)
 	{
-		v = { Vector4{}, m_VerticesWorld[i].color, m_VerticesWorld[i].uv, m_VerticesWorld[i].normal, m_VerticesWorld[i].tangent };
+		const int nrLanes = static_cast<int>(std::min<size_t>(LANES, nrVertices - i));
+		const auto load = [&](const AlignedVector<float>& stream) { return nrLanes == LANES ? Load(stream.data() + i) : LoadPartial(stream.data() + i, nrLanes); };
+		const auto store = [&](ArenaVector<float>& stream, FloatV value)
+			{
+				if (nrLanes == LANES)
+				{
+					Store(stream.data() + i, value);
+				}
+				else
+				{
+					StorePartial(stream.data() + i, value, nrLanes);
+				}
+			};
 
-		//Transfrom to camera matrix
-		v.position = matrix.TransformPoint({ m_VerticesWorld[i].position, 1 });
+		const FloatV x = load(in.positionX);
+		const FloatV y = load(in.positionY);
+		const FloatV z = load(in.positionZ);
 
-		//Perspective devide
-		v.position.x /= v.position.w;
-		v.position.y /= v.position.w;
-		v.position.z /= v.position.w;
+		//Transfrom to clip space
+		const FloatV clipX = transform(x, y, z, 0);
+		const FloatV clipY = transform(x, y, z, 1);
+		const FloatV clipZ = transform(x, y, z, 2);
+		const FloatV clipW = transform(x, y, z, 3);
+		store(out.positionX, clipX);
+		store(out.positionY, clipY);
+		store(out.positionZ, clipZ);
+		store(out.positionW, clipW);
 
-		mesh.vertices_out.emplace_back(v);
+		//Perspective divide and viewport
+		//Vertices behind the camera get a meaningless position, triangles using them are clipped first
+		store(out.screenX, Mul(Mul(Add(Div(clipX, clipW), oneV), halfV), widthV));
+		store(out.screenY, Mul(Mul(Sub(oneV, Div(clipY, clipW)), halfV), heightV));
 	}
 }
 
-bool dae::Renderer::IsVerticesInFrustrum(const Vertex_Out& vertex)
+uint32_t dae::Renderer::GetClipCode(const Vector4& position) const
+{
+	uint32_t clipCode{};
+	if (position.x < -position.w) clipCode |= CLIP_LEFT;
+	if (position.x > position.w) clipCode |= CLIP_RIGHT;
+	if (position.y < -position.w) clipCode |= CLIP_BOTTOM;
+	if (position.y > position.w) clipCode |= CLIP_TOP;
+	if (position.z < 0.f) clipCode |= CLIP_NEAR;
+	if (position.z > position.w) clipCode |= CLIP_FAR;
+
+	const float guardBand = GUARD_BAND_SCALE * position.w;
+	if (std::abs(position.x) > guardBand || std::abs(position.y) > guardBand) clipCode |= CLIP_GUARD_BAND;
+	return clipCode;
+}
+
+void dae::Renderer::AssembleTriangles(Mesh& mesh)
 {
-	if (vertex.position.x < -1.f || vertex.position.x > 1.f)
+	const bool isStrip = mesh.primitiveTopology == PrimitiveTopology::TriangleStrip;
+	const int nrIndices = static_cast<int>(mesh.indices.size());
+	const int nrTriangles = isStrip ? std::max(nrIndices - 2, 0) : nrIndices / 3;
+
+	//Enough for every triangle, only clipping can add more
+	mesh.indices_out.Reset(m_FrameArena);
+	mesh.indices_out.reserve(nrTriangles * 3);
+	for (int t = 0; t < nrTriangles; ++t)
 	{
-		return false;
+		const int i = isStrip ? t : t * 3;
+		const bool swapVertices = isStrip && (i % 2);
+
+		const uint32_t vertexIndex0 = mesh.indices[i];
+		const uint32_t vertexIndex1 = mesh.indices[i + 1 * !swapVertices + 2 * swapVertices];
+		const uint32_t vertexIndex2 = mesh.indices[i + 2 * !swapVertices + 1 * swapVertices];
+
+		//Degenerate triangles that stitch strips together
+		if (vertexIndex0 == vertexIndex1 || vertexIndex1 == vertexIndex2 || vertexIndex2 == vertexIndex0)
+		{
+			continue;
+		}
+
+		const uint32_t clipCode0 = GetClipCode(mesh.vertices_out.GetPosition(vertexIndex0));
+		const uint32_t clipCode1 = GetClipCode(mesh.vertices_out.GetPosition(vertexIndex1));
+		const uint32_t clipCode2 = GetClipCode(mesh.vertices_out.GetPosition(vertexIndex2));
+
+		//All vertices outside the same view plane
+		if ((clipCode0 & clipCode1 & clipCode2 & ~CLIP_GUARD_BAND) != 0)
+		{
+			continue;
+		}
+
+		//Only a vertex behind the near plane or far outside the screen needs real clipping,
+		//anything else is handled by the bounding box of the rasterizer
+		if (((clipCode0 | clipCode1 | clipCode2) & (CLIP_NEAR | CLIP_GUARD_BAND)) != 0)
+		{
+			ClipTriangle(mesh, vertexIndex0, vertexIndex1, vertexIndex2);
+			continue;
+		}
+
+		mesh.indices_out.push_back(vertexIndex0);
+		mesh.indices_out.push_back(vertexIndex1);
+		mesh.indices_out.push_back(vertexIndex2);
 	}
-	if (vertex.position.y < -1.f || vertex.position.y > 1.f)
+}
+
+void dae::Renderer::ClipTriangle(Mesh& mesh, uint32_t vertexIndex0, uint32_t vertexIndex1, uint32_t vertexIndex2)
+{
+	//Planes as (x, y, z, w) factors, a position is inside when the dot product is positive
+	const Vector4 clipPlanes[]
+	{
+		{ 0.f, 0.f, 1.f, 0.f },
+		{ 1.f, 0.f, 0.f, GUARD_BAND_SCALE },
+		{ -1.f, 0.f, 0.f, GUARD_BAND_SCALE },
+		{ 0.f, 1.f, 0.f, GUARD_BAND_SCALE },
+		{ 0.f, -1.f, 0.f, GUARD_BAND_SCALE }
+	};
+
+	//Every plane can add one vertex to the polygon
+	constexpr int maxPolygonSize{ 3 + static_cast<int>(std::size(clipPlanes)) };
+	uint32_t polygon[maxPolygonSize]{ vertexIndex0, vertexIndex1, vertexIndex2 };
+	uint32_t clipped[maxPolygonSize]{};
+	int polygonSize{ 3 };
+
+	VertexStreams_Out& vertices = mesh.vertices_out;
+
+	for (const Vector4& plane : clipPlanes)
 	{
-		return false;
+		int clippedSize{ 0 };
+		for (int current = 0; current < polygonSize; ++current)
+		{
+			const int next = (current + 1) % polygonSize;
+			const float currentDistance = Vector4::Dot(vertices.GetPosition(polygon[current]), plane);
+			const float nextDistance = Vector4::Dot(vertices.GetPosition(polygon[next]), plane);
+
+			if (currentDistance >= 0.f)
+			{
+				clipped[clippedSize++] = polygon[current];
+			}
+
+			//Edge crosses the plane, add the intersection as a new vertex
+			if ((currentDistance >= 0.f) != (nextDistance >= 0.f))
+			{
+				const float t = currentDistance / (currentDistance - nextDistance);
+				const uint32_t from = polygon[current];
+				const uint32_t to = polygon[next];
+				const auto addInterpolated = [&](ArenaVector<float>& stream)
+					{
+						stream.push_back(stream[from] + (stream[to] - stream[from]) * t);
+					};
+
+				clipped[clippedSize++] = static_cast<uint32_t>(vertices.Size());
+				addInterpolated(vertices.positionX);
+				addInterpolated(vertices.positionY);
+				addInterpolated(vertices.positionZ);
+				addInterpolated(vertices.positionW);
+				addInterpolated(vertices.u);
+				addInterpolated(vertices.v);
+
+				const float w = vertices.positionW.back();
+				vertices.screenX.push_back((vertices.positionX.back() / w + 1) / 2 * m_RenderWidth);
+				vertices.screenY.push_back((1 - vertices.positionY.back() / w) / 2 * m_RenderHeight);
+			}
+		}
+
+		std::copy(clipped, clipped + clippedSize, polygon);
+		polygonSize = clippedSize;
+		if (polygonSize < 3)
+		{
+			return;
+		}
 	}
-	if (vertex.position.z < 0.f || vertex.position.z > 1.f)
+
+	//Fan triangulation keeps the winding of the original triangle
+	for (int i = 1; i < polygonSize - 1; ++i)
 	{
-		return false;
+		mesh.indices_out.push_back(polygon[0]);
+		mesh.indices_out.push_back(polygon[i]);
+		mesh.indices_out.push_back(polygon[i + 1]);
 	}
-	return true;
 }
 
-void dae::Renderer::DrawTriangle(int i, bool swapVertices, const Mesh& mesh)
+void dae::Renderer::CreateTiles()
 {
-	//Predefine indexes
-	const uint32_t vertexIndex0 = i;
-	const uint32_t vertexIndex1 = i + 1 * !swapVertices + 2 * swapVertices;
-	const uint32_t vertexIndex2 = i + 2 * !swapVertices + 1 * swapVertices;
+	m_TilesX = (m_RenderWidth + TILE_SIZE - 1) / TILE_SIZE;
+	m_TilesY = (m_RenderHeight + TILE_SIZE - 1) / TILE_SIZE;
 
-	//Calculate edges
-	const Vector2 edgeV0V1 = m_VerticesScreenSpace[vertexIndex1] - m_VerticesScreenSpace[vertexIndex0];
-	const Vector2 edgeV1V2 = m_VerticesScreenSpace[vertexIndex2] - m_VerticesScreenSpace[vertexIndex1];
-	const Vector2 edgeV2V0 = m_VerticesScreenSpace[vertexIndex0] - m_VerticesScreenSpace[vertexIndex2];
-
-	//Check if triangle is valid
-	if (edgeV0V1.SqrMagnitude() < FLT_EPSILON || edgeV1V2.SqrMagnitude() < FLT_EPSILON || edgeV2V0.SqrMagnitude() < FLT_EPSILON)
+	m_Tiles.resize(m_TilesX * m_TilesY);
+	for (int ty = 0; ty < m_TilesY; ++ty)
 	{
-		return;
+		for (int tx = 0; tx < m_TilesX; ++tx)
+		{
+			Tile& tile = m_Tiles[tx + ty * m_TilesX];
+			tile.minX = tx * TILE_SIZE;
+			tile.minY = ty * TILE_SIZE;
+			tile.maxX = std::min(tile.minX + TILE_SIZE, m_RenderWidth);
+			tile.maxY = std::min(tile.minY + TILE_SIZE, m_RenderHeight);
+		}
 	}
+}
 
-	if (IsVerticesInFrustrum(mesh.vertices_out[vertexIndex0]) == false) { return; }
-	if (IsVerticesInFrustrum(mesh.vertices_out[vertexIndex1]) == false) { return; }
-	if (IsVerticesInFrustrum(mesh.vertices_out[vertexIndex2]) == false) { return; }
+void dae::Renderer::SetupTriangles(const Mesh& mesh)
+{
+	const int64_t halfPixel = SUBPIXEL_SCALE / 2;
 
-	const float fullTriangleArea = Vector2::Cross(edgeV0V1, edgeV1V2);
+	const int64_t sampleReach = IsCoverageAA() ? MAX_SAMPLE_OFFSET : 0;
 
-	//Create bounding box for optimized rendering
-	Vector2 minBoundingBox{ Vector2::Min(m_VerticesScreenSpace[vertexIndex0], Vector2::Min(m_VerticesScreenSpace[vertexIndex1], m_VerticesScreenSpace[vertexIndex2])) };
-	Vector2 maxBoundingBox{ Vector2::Max(m_VerticesScreenSpace[vertexIndex0], Vector2::Max(m_VerticesScreenSpace[vertexIndex1], m_VerticesScreenSpace[vertexIndex2])) };
-	minBoundingBox.Clamp(m_Width, m_Height);
-	maxBoundingBox.Clamp(m_Width, m_Height);
-	const int offset = 1;
-	int maxX = (int)maxBoundingBox.x + offset;
-	int maxY = (int)maxBoundingBox.y + offset;
+	//Reversed z / w = scale + offset / w
+	const bool isReversedDepth = m_DepthFormat == DepthFormat::ReversedFloat32;
+	const float reversedZScale = m_Camera.reversedProjectionMatrix[2].z;
+	const float reversedZOffset = m_Camera.reversedProjectionMatrix[3].z;
 
-	//Loop over every pixel that matches the bounding box
-	for (int px{ (int)minBoundingBox.x }; px < maxX; ++px)
+	const uint32_t nrTriangles = static_cast<uint32_t>(mesh.indices_out.size() / 3);
+	m_TriangleSetups.reserve(m_TriangleSetups.size() + nrTriangles);
+	for (uint32_t t = 0; t < nrTriangles; ++t)
 	{
-		for (int py{ (int)minBoundingBox.y }; py < maxY; ++py)
+		const uint32_t vertexIndex0 = mesh.indices_out[t * 3];
+		const uint32_t vertexIndex1 = mesh.indices_out[t * 3 + 1];
+		const uint32_t vertexIndex2 = mesh.indices_out[t * 3 + 2];
+
+		//Snap the vertices to the sub-pixel grid
+		const VertexStreams_Out& vertices = mesh.vertices_out;
+		const int64_t x0 = std::lrint(vertices.screenX[vertexIndex0] * SUBPIXEL_SCALE);
+		const int64_t y0 = std::lrint(vertices.screenY[vertexIndex0] * SUBPIXEL_SCALE);
+		const int64_t x1 = std::lrint(vertices.screenX[vertexIndex1] * SUBPIXEL_SCALE);
+		const int64_t y1 = std::lrint(vertices.screenY[vertexIndex1] * SUBPIXEL_SCALE);
+		const int64_t x2 = std::lrint(vertices.screenX[vertexIndex2] * SUBPIXEL_SCALE);
+		const int64_t y2 = std::lrint(vertices.screenY[vertexIndex2] * SUBPIXEL_SCALE);
+
+		//Twice the signed area, y points down so clockwise triangles on screen are front facing
+		const int64_t fullTriangleArea = (x2 - x1) * (y0 - y1) - (y2 - y1) * (x0 - x1);
+
+		//Back face culling
+		if (fullTriangleArea < 0)
 		{
-			ColorRGB finalColor{ .0f, .0f, .0f };
-			const int index = px + py * m_Width;
+			continue;
+		}
 
-			const Vector2 pointToSide = Vector2{ (float)px, (float)py };
-			const Vector2 pointV0 = pointToSide - m_VerticesScreenSpace[vertexIndex0];
-			const Vector2 pointV1 = pointToSide - m_VerticesScreenSpace[vertexIndex1];
-			const Vector2 pointV2 = pointToSide - m_VerticesScreenSpace[vertexIndex2];
+		//After snapping the triangle can have no area left
+		if (fullTriangleArea == 0)
+		{
+			continue;
+		}
 
-			//Check if pixel is in triangle
-			float edge0 = Vector2::Cross(edgeV0V1, pointV0);
-			if (edge0 <= 0)
-			{
-				continue;
-			}
-			float edge1 = Vector2::Cross(edgeV1V2, pointV1);
-			if (edge1 <= 0)
-			{
-				continue;
-			}
-			float edge2 = Vector2::Cross(edgeV2V0, pointV2);
-			if (edge2 <= 0)
-			{
-				continue;
-			}
+		//Bounding box of the pixel centers that can be inside the triangle, with coverage AA of the pixels with a sample inside
+		const int64_t minOffset = halfPixel + sampleReach;
+		const int64_t maxOffset = halfPixel - sampleReach;
+		const int minX = std::max(static_cast<int>((std::min(x0, std::min(x1, x2)) - minOffset + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS), 0);
+		const int minY = std::max(static_cast<int>((std::min(y0, std::min(y1, y2)) - minOffset + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS), 0);
+		const int maxX = std::min(static_cast<int>((std::max(x0, std::max(x1, x2)) - maxOffset) >> SUBPIXEL_BITS) + 1, m_RenderWidth);
+		const int maxY = std::min(static_cast<int>((std::max(y0, std::max(y1, y2)) - maxOffset) >> SUBPIXEL_BITS) + 1, m_RenderHeight);
+
+		//No pixel center between the vertices, or everything off screen
+		if (minX >= maxX || minY >= maxY)
+		{
+			continue;
+		}
 
-			//Calculate the barycentric weight
-			const float weightV0 = edge1 / fullTriangleArea;
-			const float weightV1 = edge2 / fullTriangleArea;
-			const float weightV2 = edge0 / fullTriangleArea;
+		TriangleSetup setup{};
+		setup.a[0] = y1 - y2; setup.b[0] = x2 - x1; setup.c[0] = x1 * y2 - y1 * x2;
+		setup.a[1] = y2 - y0; setup.b[1] = x0 - x2; setup.c[1] = x2 * y0 - y2 * x0;
+		setup.a[2] = y0 - y1; setup.b[2] = x1 - x0; setup.c[2] = x0 * y1 - y0 * x1;
 
-			const float depthV0 = mesh.vertices_out[vertexIndex0].position.z;
-			const float depthV1 = mesh.vertices_out[vertexIndex1].position.z;
-			const float depthV2 = mesh.vertices_out[vertexIndex2].position.z;
+		//Top-left rule: pixels exactly on a right or bottom edge belong to the neighbouring triangle
+		for (int edge = 0; edge < 3; ++edge)
+		{
+			setup.bias[edge] = (setup.a[edge] > 0 || (setup.a[edge] == 0 && setup.b[edge] > 0)) ? 0 : -1;
+		}
 
-			const float interpolatedDepth
+		//A sub-pixel triangle touches a single pixel center at most, check if it really covers it
+		if (maxX - minX == 1 && maxY - minY == 1 && sampleReach == 0)
+		{
+			const int64_t centerX = (static_cast<int64_t>(minX) << SUBPIXEL_BITS) + halfPixel;
+			const int64_t centerY = (static_cast<int64_t>(minY) << SUBPIXEL_BITS) + halfPixel;
+			bool isCovered{ true };
+			for (int edge = 0; edge < 3; ++edge)
 			{
-				1.0f /
-				(weightV0 / depthV0 +
-				weightV1 / depthV1 +
-				weightV2 / depthV2)
-			};
-
-			if (m_pDepthBufferPixels[index] < interpolatedDepth)
+				isCovered &= setup.a[edge] * centerX + setup.b[edge] * centerY + setup.c[edge] + setup.bias[edge] >= 0;
+			}
+			if (!isCovered)
 			{
 				continue;
 			}
+		}
+
+		setup.invArea = 1.f / static_cast<float>(fullTriangleArea);
+		setup.material = mesh.material;
+		setup.minX = minX;
+		setup.minY = minY;
+		setup.maxX = maxX;
+		setup.maxY = maxY;
 
-			m_pDepthBufferPixels[index] = interpolatedDepth;
+		const uint32_t vertexIndices[3]{ vertexIndex0, vertexIndex1, vertexIndex2 };
+		for (int vertex = 0; vertex < 3; ++vertex)
+		{
+			const uint32_t vertexIndex = vertexIndices[vertex];
 
-			if (m_IsDepthBuffer)
+			//z / w is linear in screen space, so depth interpolates without perspective correction
+			//Reversed-Z uses z of the reversed projection, w is view space z in both
+			if (isReversedDepth)
 			{
-				
+				setup.depth[vertex] = -(reversedZScale + reversedZOffset / vertices.positionW[vertexIndex]);
 			}
 			else
 			{
-				//Texture check?
-				const float invInterpolatedDepthV0{ 1.f / mesh.vertices_out[vertexIndex0].position.w };
-				const float invInterpolatedDepthV1{ 1.f / mesh.vertices_out[vertexIndex1].position.w };
-				const float invInterpolatedDepthV2{ 1.f / mesh.vertices_out[vertexIndex2].position.w };
+				setup.depth[vertex] = vertices.positionZ[vertexIndex] / vertices.positionW[vertexIndex];
+			}
+			setup.invW[vertex] = 1.f / vertices.positionW[vertexIndex];
+			setup.uv[vertex] = Vector2{ vertices.u[vertexIndex], vertices.v[vertexIndex] } * setup.invW[vertex];
+		}
 
-				const float interpolatedPixelDepth
-				{
-					1.f /
-					(
-						weightV0 * invInterpolatedDepthV0 +
-						weightV1 * invInterpolatedDepthV1 +
-						weightV2 * invInterpolatedDepthV2
-					)
-				};
+		//Interpolated depth never gets closer than the closest vertex
+		setup.minDepth = std::min(setup.depth[0], std::min(setup.depth[1], setup.depth[2]));
 
-				const Vector2 pixelUV
-				{
-					(weightV0 * mesh.vertices_out[vertexIndex0].uv * invInterpolatedDepthV0 +
-					weightV1 * mesh.vertices_out[vertexIndex1].uv * invInterpolatedDepthV1 +
-					weightV2 * mesh.vertices_out[vertexIndex2].uv * invInterpolatedDepthV2)
-						* interpolatedPixelDepth
-				};
+		//A weight changes by a or b of its edge per sub-pixel step
+		const float pixelStep = SUBPIXEL_SCALE * setup.invArea;
+		for (int vertex = 0; vertex < 3; ++vertex)
+		{
+			const float weightStepX = static_cast<float>(setup.a[vertex]) * pixelStep;
+			const float weightStepY = static_cast<float>(setup.b[vertex]) * pixelStep;
+			setup.uvGradientX += setup.uv[vertex] * weightStepX;
+			setup.uvGradientY += setup.uv[vertex] * weightStepY;
+			setup.invWGradientX += setup.invW[vertex] * weightStepX;
+			setup.invWGradientY += setup.invW[vertex] * weightStepY;
+		}
+
+		m_TriangleSetups.push_back(setup);
+	}
+}
 
-				finalColor = { m_pTexture->Sample(pixelUV) };
+void dae::Renderer::BinTriangles()
+{
+	//Bounding box is already on screen, max is exclusive
+	const auto forEachTile = [&](const TriangleSetup& setup, const auto& function)
+		{
+			for (int ty = setup.minY / TILE_SIZE; ty <= (setup.maxY - 1) / TILE_SIZE; ++ty)
+			{
+				for (int tx = setup.minX / TILE_SIZE; tx <= (setup.maxX - 1) / TILE_SIZE; ++tx)
+				{
+					function(m_Tiles[tx + ty * m_TilesX]);
+				}
 			}
-			//const Vector2 pixelUV
-			//{
-			//	(weightV0 * m_VerticesWorld[vertexIndex0].uv / depthV0 +
-			//	weightV1 * m_VerticesWorld[vertexIndex1].uv / depthV1 +
-			//	weightV2 * m_VerticesWorld[vertexIndex2].uv / depthV2)
-			//		* interpolatedDepth
-			//};
+		};
 
-			//Calculate color
-			//finalColor = { m_pTexture->Sample(pixelUV) };
+	//Count first, so every bin list is allocated once at its final size
+	uint32_t* pBinSizes = m_FrameArena.Allocate<uint32_t>(m_Tiles.size());
+	std::fill_n(pBinSizes, m_Tiles.size(), 0u);
+	for (const TriangleSetup& setup : m_TriangleSetups)
+	{
+		forEachTile(setup, [&](const Tile& tile) { ++pBinSizes[&tile - m_Tiles.data()]; });
+	}
 
-			//Update Color in Buffer
-			finalColor.MaxToOne();
+	for (size_t i = 0; i < m_Tiles.size(); ++i)
+	{
+		m_Tiles[i].triangles.Reset(m_FrameArena);
+		m_Tiles[i].triangles.reserve(pBinSizes[i]);
+	}
 
-			m_pBackBufferPixels[px + (py * m_Width)] = SDL_MapRGB(m_pBackBuffer->format,
-				static_cast<uint8_t>(finalColor.r * 255),
-				static_cast<uint8_t>(finalColor.g * 255),
-				static_cast<uint8_t>(finalColor.b * 255));
+	//The arena isn't shared by the workers, so the sample record pools are handed out here
+	const bool isCoverageAA = IsCoverageAA();
+	for (size_t i = 0; i < m_Tiles.size(); ++i)
+	{
+		Tile& tile = m_Tiles[i];
+		tile.pSampleRecords = nullptr;
+		if (isCoverageAA && pBinSizes[i] > 0)
+		{
+			tile.sampleRecordCapacity = std::max(tile.sampleRecordCapacity, MIN_SAMPLE_RECORDS);
+			tile.pSampleRecords = m_FrameArena.Allocate<SampleRecord>(tile.sampleRecordCapacity);
 		}
 	}
-}
 
-size_t dae::Renderer::FindReserveSize()
-{
-	size_t max{};
-	for (const Mesh& mesh : m_MeshesWorld)
+	const uint32_t nrTriangles = static_cast<uint32_t>(m_TriangleSetups.size());
+	for (uint32_t t = 0; t < nrTriangles; ++t)
 	{
-		max = std::max(max, mesh.indices.size());
+		forEachTile(m_TriangleSetups[t], [&](Tile& tile) { tile.triangles.push_back(t); });
 	}
-	return max;
 }
 
-bool Renderer::SaveBufferToImage() const
+void dae::Renderer::RasterizeTile(Tile& tile)
 {
-	return SDL_SaveBMP(m_pBackBuffer, "Rasterizer_ColorBuffer.bmp");
+	if (tile.triangles.empty())
+	{
+		return;
+	}
+
+	ClearTile(tile);
+
+	for (const uint32_t triangleIndex : tile.triangles)
+	{
+		DrawTriangle(m_TriangleSetups[triangleIndex], tile, triangleIndex);
+	}
+
+	if (IsCoverageAA())
+	{
+		ResolveSamples(tile);
+
+		//Twice the most the tile needed so far, so edges moving into it rarely find the pool full
+		//A full tile has a record for every pixel at most, so a pool of that size never runs out
+		const uint32_t capacity = std::max(tile.sampleRecordCapacity, 2 * tile.nrSampleRecordsNeeded);
+		tile.sampleRecordCapacity = std::min(capacity, static_cast<uint32_t>(TILE_SIZE * TILE_SIZE));
+	}
+}
+
+void dae::Renderer::ClearTile(Tile& tile)
+{
+	//A swizzled tile is one contiguous range, a linear one a range per row
+	const bool isSwizzled = m_IsSwizzledLayout;
+	const int width = isSwizzled ? TILE_SIZE * TILE_SIZE : tile.maxX - tile.minX;
+	const int nrRows = isSwizzled ? 1 : tile.maxY - tile.minY;
+	for (int row{ 0 }; row < nrRows; ++row)
+	{
+		const int index = GetPixelIndex(tile.minX, tile.minY + row);
+		std::fill_n(m_pColorBufferPixels + index, width, m_ClearColor);
+		switch (m_DepthFormat)
+		{
+		case DepthFormat::Unorm16:
+			std::fill_n(m_pDepth16BufferPixels + index, width, static_cast<uint16_t>(DEPTH16_MAX));
+			break;
+		case DepthFormat::Fixed24:
+			std::fill_n(m_pDepth24BufferPixels + index, width, DEPTH24_MAX);
+			break;
+		default:
+			std::fill_n(m_pDepthBufferPixels + index, width, FLT_MAX);
+			break;
+		}
+		if (m_IsVisibilityBuffer)
+		{
+			std::fill_n(m_pVisibilityBufferPixels + index, width, EMPTY_VISIBILITY_ID);
+		}
+		if (IsCoverageAA())
+		{
+			std::fill_n(m_pSampleRecordIndices + index, width, EMPTY_SAMPLE_RECORD);
+		}
+	}
+	tile.nrSampleRecords = 0;
+	tile.freeSampleRecord = EMPTY_SAMPLE_RECORD;
+	tile.nrSampleRecordsNeeded = 0;
+
+	//Tiles are a multiple of the Hi-Z block size, so the blocks belong to this tile only
+	const int hiZMinX = tile.minX / HIZ_BLOCK_SIZE;
+	const int hiZMaxX = (tile.maxX + HIZ_BLOCK_SIZE - 1) / HIZ_BLOCK_SIZE;
+	for (int hiZY{ tile.minY / HIZ_BLOCK_SIZE }; hiZY < (tile.maxY + HIZ_BLOCK_SIZE - 1) / HIZ_BLOCK_SIZE; ++hiZY)
+	{
+		std::fill_n(m_pHiZBufferPixels + hiZMinX + hiZY * m_HiZWidth, hiZMaxX - hiZMinX, FLT_MAX);
+	}
+
+	tile.nrHiZCulledBlocks = 0;
+	tile.isCleared = true;
+}
+
+void dae::Renderer::FillTile(const Tile& tile)
+{
+	for (int py{ tile.minY }; py < tile.maxY; ++py)
+	{
+		std::fill_n(m_pRenderTargetPixels + tile.minX + py * m_RenderWidth, tile.maxX - tile.minX, m_ClearColor);
+	}
+}
+
+void dae::Renderer::DetileTile(const Tile& tile)
+{
+	for (int py{ tile.minY }; py < tile.maxY; ++py)
+	{
+		uint32_t* pRow = m_pRenderTargetPixels + py * m_RenderWidth;
+		for (int px{ tile.minX }; px < tile.maxX; px += HIZ_BLOCK_SIZE)
+		{
+			std::copy_n(m_pColorBufferPixels + GetPixelIndex(px, py), std::min(HIZ_BLOCK_SIZE, tile.maxX - px), pRow + px);
+		}
+	}
+}
+
+void dae::Renderer::UpscaleRows(uint32_t firstRow, uint32_t endRow)
+{
+	for (uint32_t y = firstRow; y < endRow; ++y)
+	{
+		const uint32_t* pSourceRow = m_pRenderTargetPixels + ((2 * y + 1) * m_RenderHeight / (2 * m_Height)) * m_RenderWidth;
+		uint32_t* pRow = m_pBackBufferPixels + y * m_Width;
+		for (int x = 0; x < m_Width; ++x)
+		{
+			pRow[x] = pSourceRow[m_UpscaleColumns[x]];
+		}
+	}
+}
+
+int dae::Renderer::GetPixelIndex(int px, int py) const
+{
+	if (!m_IsSwizzledLayout)
+	{
+		return px + py * m_RenderWidth;
+	}
+
+	//Interleave the bits of the block coordinates inside the tile
+	const int blockX = (px % TILE_SIZE) / HIZ_BLOCK_SIZE;
+	const int blockY = (py % TILE_SIZE) / HIZ_BLOCK_SIZE;
+	int blockIndex{ 0 };
+	for (int bit{ 0 }; (blockX | blockY) >> bit != 0; ++bit)
+	{
+		blockIndex |= ((blockX >> bit) & 1) << (2 * bit);
+		blockIndex |= ((blockY >> bit) & 1) << (2 * bit + 1);
+	}
+
+	const int tileIndex = px / TILE_SIZE + (py / TILE_SIZE) * m_TilesX;
+	return tileIndex * TILE_SIZE * TILE_SIZE
+		+ blockIndex * HIZ_BLOCK_SIZE * HIZ_BLOCK_SIZE
+		+ (py % HIZ_BLOCK_SIZE) * HIZ_BLOCK_SIZE + px % HIZ_BLOCK_SIZE;
+}
+
+void dae::Renderer::DrawTriangle(const TriangleSetup& setup, Tile& tile, uint32_t visibilityId)
+{
+	using namespace simd;
+
+	const int64_t a0 = setup.a[0], b0 = setup.b[0], c0 = setup.c[0];
+	const int64_t a1 = setup.a[1], b1 = setup.b[1], c1 = setup.c[1];
+	const int64_t a2 = setup.a[2], b2 = setup.b[2], c2 = setup.c[2];
+	const int64_t bias0 = setup.bias[0], bias1 = setup.bias[1], bias2 = setup.bias[2];
+
+	//Clip the bounding box to the tile so no other worker's pixels are touched
+	const int64_t halfPixel = SUBPIXEL_SCALE / 2;
+	const int minX = std::max(setup.minX, tile.minX);
+	const int minY = std::max(setup.minY, tile.minY);
+	const int maxX = std::min(setup.maxX, tile.maxX);
+	const int maxY = std::min(setup.maxY, tile.maxY);
+	if (minX >= maxX || minY >= maxY)
+	{
+		return;
+	}
+
+	//Pixels are processed in blocks of LANES wide, blocks are aligned so they never straddle two tiles
+	const int blockMinX = minX - minX % LANES;
+	const int blockMaxX = maxX + (LANES - maxX % LANES) % LANES;
+
+	//Edge values at the center of the first pixel, one pixel step adds a constant
+	const int64_t startX = (static_cast<int64_t>(blockMinX) << SUBPIXEL_BITS) + halfPixel;
+	const int64_t startY = (static_cast<int64_t>(minY) << SUBPIXEL_BITS) + halfPixel;
+	const int64_t edgeOrigin0 = a0 * startX + b0 * startY + c0 + bias0;
+	const int64_t edgeOrigin1 = a1 * startX + b1 * startY + c1 + bias1;
+	const int64_t edgeOrigin2 = a2 * startX + b2 * startY + c2 + bias2;
+	const int64_t stepX0 = a0 * SUBPIXEL_SCALE, stepY0 = b0 * SUBPIXEL_SCALE;
+	const int64_t stepX1 = a1 * SUBPIXEL_SCALE, stepY1 = b1 * SUBPIXEL_SCALE;
+	const int64_t stepX2 = a2 * SUBPIXEL_SCALE, stepY2 = b2 * SUBPIXEL_SCALE;
+
+	//The vector kernel steps the edges in 32 bit lanes, only very large triangles need the 64 bit fallback
+	//An edge function is linear, so checking the corners of the walked area is enough
+	const int64_t limit = int64_t{ 1 } << 30;
+	const int64_t rangeX = static_cast<int64_t>(blockMaxX - blockMinX) * SUBPIXEL_SCALE;
+	const int64_t rangeY = static_cast<int64_t>(maxY - minY) * SUBPIXEL_SCALE;
+	const auto isEdgeInRange = [&](int64_t start, int64_t a, int64_t b)
+		{
+			return std::abs(start) < limit && std::abs(start + a * rangeX) < limit
+				&& std::abs(start + b * rangeY) < limit && std::abs(start + a * rangeX + b * rangeY) < limit;
+		};
+	const bool isInt32Range = isEdgeInRange(edgeOrigin0, a0, b0) && isEdgeInRange(edgeOrigin1, a1, b1) && isEdgeInRange(edgeOrigin2, a2, b2);
+
+	//Edge offsets of the lanes within a block, and the step to the next block
+	uint32_t laneOffset0[LANES], laneOffset1[LANES], laneOffset2[LANES];
+	for (int lane = 0; lane < LANES; ++lane)
+	{
+		laneOffset0[lane] = static_cast<uint32_t>(stepX0 * lane);
+		laneOffset1[lane] = static_cast<uint32_t>(stepX1 * lane);
+		laneOffset2[lane] = static_cast<uint32_t>(stepX2 * lane);
+	}
+	const IntV laneOffset0V = Load(laneOffset0), laneOffset1V = Load(laneOffset1), laneOffset2V = Load(laneOffset2);
+	const IntV blockStep0V = Set1(static_cast<int32_t>(stepX0 * LANES));
+	const IntV blockStep1V = Set1(static_cast<int32_t>(stepX1 * LANES));
+	const IntV blockStep2V = Set1(static_cast<int32_t>(stepX2 * LANES));
+	const IntV bias0V = Set1(static_cast<int32_t>(bias0));
+	const IntV bias1V = Set1(static_cast<int32_t>(bias1));
+	const IntV bias2V = Set1(static_cast<int32_t>(bias2));
+	const IntV insideV = Set1(-1);
+
+	const IntV laneIndicesV = LaneIndices();
+	const IntV firstPixelV = Set1(minX - 1);
+	const IntV endPixelV = Set1(maxX);
+
+	//Per triangle constants of the interpolation
+	const FloatV invAreaV = Set1(setup.invArea);
+
+	const FloatV depthV0V = Set1(setup.depth[0]);
+	const FloatV depthV1V = Set1(setup.depth[1]);
+	const FloatV depthV2V = Set1(setup.depth[2]);
+
+	const FloatV invW0V = Set1(setup.invW[0]);
+	const FloatV invW1V = Set1(setup.invW[1]);
+	const FloatV invW2V = Set1(setup.invW[2]);
+
+	const FloatV u0V = Set1(setup.uv[0].x), v0V = Set1(setup.uv[0].y);
+	const FloatV u1V = Set1(setup.uv[1].x), v1V = Set1(setup.uv[1].y);
+	const FloatV u2V = Set1(setup.uv[2].x), v2V = Set1(setup.uv[2].y);
+
+	const FloatV uGradientXV = Set1(setup.uvGradientX.x), vGradientXV = Set1(setup.uvGradientX.y);
+	const FloatV uGradientYV = Set1(setup.uvGradientY.x), vGradientYV = Set1(setup.uvGradientY.y);
+	const FloatV invWGradientXV = Set1(setup.invWGradientX), invWGradientYV = Set1(setup.invWGradientY);
+
+	const FloatV oneV = Set1(1.f);
+	const IntV visibilityIdV = Set1(static_cast<int32_t>(visibilityId));
+	const Texture* pTexture = GetDiffuseTexture(setup.material);
+
+	//Coverage AA: edge and depth offsets of every sample position from the pixel center
+	const bool isCoverageAA = IsCoverageAA();
+	const int nrSamples = isCoverageAA ? m_SampleCount : 0;
+	const auto& sampleOffsets = m_SampleCount == 8 ? SAMPLE_OFFSETS_8X : SAMPLE_OFFSETS_4X;
+	int64_t sampleEdgeOffsets[3][MAX_SAMPLE_COUNT]{};
+	IntV sampleEdgeOffsetsV[3][MAX_SAMPLE_COUNT]{};
+	IntV sampleBitsV[MAX_SAMPLE_COUNT]{};
+	float sampleDepthOffsets[MAX_SAMPLE_COUNT]{};
+	for (int sample = 0; sample < nrSamples; ++sample)
+	{
+		for (int edge = 0; edge < 3; ++edge)
+		{
+			sampleEdgeOffsets[edge][sample] = setup.a[edge] * sampleOffsets[sample][0] + setup.b[edge] * sampleOffsets[sample][1];
+			sampleEdgeOffsetsV[edge][sample] = Set1(static_cast<int32_t>(sampleEdgeOffsets[edge][sample]));
+			sampleDepthOffsets[sample] += static_cast<float>(sampleEdgeOffsets[edge][sample]) * setup.invArea * setup.depth[edge];
+		}
+		sampleBitsV[sample] = Set1(1 << sample);
+	}
+	const IntV allSamplesV = Set1((1 << nrSamples) - 1);
+	const IntV zeroV = Set1(0);
+
+	//Pixels whose center is far enough inside or outside an edge have all samples on the same side of it
+	IntV allInsideEdgeV[3]{}, allOutsideEdgeV[3]{};
+	for (int edge = 0; edge < 3; ++edge)
+	{
+		int64_t minOffset{}, maxOffset{};
+		for (int sample = 0; sample < nrSamples; ++sample)
+		{
+			minOffset = std::min(minOffset, sampleEdgeOffsets[edge][sample]);
+			maxOffset = std::max(maxOffset, sampleEdgeOffsets[edge][sample]);
+		}
+		allInsideEdgeV[edge] = Set1(static_cast<int32_t>(-minOffset - 1));
+		allOutsideEdgeV[edge] = Set1(static_cast<int32_t>(-maxOffset));
+	}
+
+	//Walk the bounding box in Hi-Z blocks, inside a block scanline by scanline in the same order as the buffers are stored
+	for (int blockY{ minY - minY % HIZ_BLOCK_SIZE }; blockY < maxY; blockY += HIZ_BLOCK_SIZE)
+	{
+		const int rowBegin = std::max(blockY, minY);
+		const int rowEnd = std::min(blockY + HIZ_BLOCK_SIZE, maxY);
+
+		for (int blockX{ minX - minX % HIZ_BLOCK_SIZE }; blockX < maxX; blockX += HIZ_BLOCK_SIZE)
+		{
+			//Skip the whole block when the triangle is behind everything drawn in it
+			const int hiZIndex = blockX / HIZ_BLOCK_SIZE + (blockY / HIZ_BLOCK_SIZE) * m_HiZWidth;
+			if (setup.minDepth > m_pHiZBufferPixels[hiZIndex])
+			{
+				++tile.nrHiZCulledBlocks;
+				continue;
+			}
+
+			const int columnBegin = std::max(blockX, blockMinX);
+			const int columnEnd = std::min(blockX + HIZ_BLOCK_SIZE, maxX);
+			bool isDepthWritten{ false };
+
+			//When the bounding box spans the whole block every depth value in it passes through the kernel,
+			//so the new farthest depth comes for free. Otherwise the old value stays, depth only ever gets closer
+			const bool isWholeBlock = minX <= blockX && maxX >= std::min(blockX + HIZ_BLOCK_SIZE, m_RenderWidth)
+				&& minY <= blockY && maxY >= std::min(blockY + HIZ_BLOCK_SIZE, m_RenderHeight);
+			//Reversed-Z stores negated depth, so the start has to be below every format
+			FloatV blockMaxDepthV = Set1(-FLT_MAX);
+
+			for (int py{ rowBegin }; py < rowEnd; ++py)
+			{
+				//Edge values at the first pixel of this row inside the block
+				const int64_t stepsX = columnBegin - blockMinX;
+				const int64_t stepsY = py - minY;
+				int64_t edge0 = edgeOrigin0 + stepsX * stepX0 + stepsY * stepY0;
+				int64_t edge1 = edgeOrigin1 + stepsX * stepX1 + stepsY * stepY1;
+				int64_t edge2 = edgeOrigin2 + stepsX * stepX2 + stepsY * stepY2;
+				IntV edge0V = Add(Set1(static_cast<int32_t>(edge0)), laneOffset0V);
+				IntV edge1V = Add(Set1(static_cast<int32_t>(edge1)), laneOffset1V);
+				IntV edge2V = Add(Set1(static_cast<int32_t>(edge2)), laneOffset2V);
+
+				int index = GetPixelIndex(columnBegin, py);
+				for (int px{ columnBegin }; px < columnEnd; px += LANES, index += LANES)
+				{
+					//Check which pixels are in the triangle, one sign test covers all edges
+					IntV coverage;
+					IntV sampleMaskV = zeroV;
+					FloatV weightV0, weightV1, weightV2;
+					if (isInt32Range)
+					{
+						coverage = CmpGT(Or(Or(edge0V, edge1V), edge2V), insideV);
+						if (nrSamples > 0)
+						{
+							//Only pixels close to an edge need every sample tested
+							const IntV allInsideV = And(And(CmpGT(edge0V, allInsideEdgeV[0]), CmpGT(edge1V, allInsideEdgeV[1])), CmpGT(edge2V, allInsideEdgeV[2]));
+							const IntV allOutsideV = Or(Or(CmpLT(edge0V, allOutsideEdgeV[0]), CmpLT(edge1V, allOutsideEdgeV[1])), CmpLT(edge2V, allOutsideEdgeV[2]));
+							sampleMaskV = And(allInsideV, allSamplesV);
+							if (MoveMask(Or(allInsideV, allOutsideV)) != (1 << LANES) - 1)
+							{
+								for (int sample = 0; sample < nrSamples; ++sample)
+								{
+									const IntV sampleEdges = Or(Or(Add(edge0V, sampleEdgeOffsetsV[0][sample]), Add(edge1V, sampleEdgeOffsetsV[1][sample])), Add(edge2V, sampleEdgeOffsetsV[2][sample]));
+									sampleMaskV = Or(sampleMaskV, And(CmpGT(sampleEdges, insideV), sampleBitsV[sample]));
+								}
+							}
+						}
+						weightV0 = Mul(ToFloat(Sub(edge0V, bias0V)), invAreaV);
+						weightV1 = Mul(ToFloat(Sub(edge1V, bias1V)), invAreaV);
+						weightV2 = Mul(ToFloat(Sub(edge2V, bias2V)), invAreaV);
+
+						edge0V = Add(edge0V, blockStep0V);
+						edge1V = Add(edge1V, blockStep1V);
+						edge2V = Add(edge2V, blockStep2V);
+					}
+					else
+					{
+						uint32_t laneCoverage[LANES], laneSampleMask[LANES]{};
+						float laneEdge0[LANES], laneEdge1[LANES], laneEdge2[LANES];
+						for (int lane = 0; lane < LANES; ++lane, edge0 += stepX0, edge1 += stepX1, edge2 += stepX2)
+						{
+							laneCoverage[lane] = (edge0 | edge1 | edge2) < 0 ? 0u : ~0u;
+							for (int sample = 0; sample < nrSamples; ++sample)
+							{
+								const int64_t sampleEdges = (edge0 + sampleEdgeOffsets[0][sample]) | (edge1 + sampleEdgeOffsets[1][sample]) | (edge2 + sampleEdgeOffsets[2][sample]);
+								laneSampleMask[lane] |= sampleEdges < 0 ? 0u : 1u << sample;
+							}
+							laneEdge0[lane] = static_cast<float>(edge0 - bias0);
+							laneEdge1[lane] = static_cast<float>(edge1 - bias1);
+							laneEdge2[lane] = static_cast<float>(edge2 - bias2);
+						}
+						coverage = Load(laneCoverage);
+						sampleMaskV = Load(laneSampleMask);
+						weightV0 = Mul(Load(laneEdge0), invAreaV);
+						weightV1 = Mul(Load(laneEdge1), invAreaV);
+						weightV2 = Mul(Load(laneEdge2), invAreaV);
+					}
+
+					//Blocks can stick out of the bounding box on both sides
+					const IntV pixelXV = Add(Set1(px), laneIndicesV);
+					const IntV insideBoxV = And(CmpGT(pixelXV, firstPixelV), CmpLT(pixelXV, endPixelV));
+					coverage = And(coverage, insideBoxV);
+
+					//Only the last block of a row can run past the right side of the screen
+					const int nrLanes = std::min(LANES, m_RenderWidth - px);
+
+					//With coverage AA only pixels that are covered completely and have no sample record go through the vector depth test,
+					//the other pixels the triangle touches are tested per sample
+					int sampleLaneMask{ 0 };
+					if (isCoverageAA)
+					{
+						const uint32_t* pRecordIndices = m_pSampleRecordIndices + index;
+						const IntV recordIndices = nrLanes == LANES ? Load(pRecordIndices) : LoadPartial(pRecordIndices, nrLanes);
+						const IntV hasRecordV = CmpGT(recordIndices, insideV);
+						const IntV isFullV = CmpGT(sampleMaskV, Sub(allSamplesV, Set1(1)));
+						const IntV isTouchedV = CmpGT(sampleMaskV, zeroV);
+						coverage = And(Select(hasRecordV, zeroV, isFullV), insideBoxV);
+						sampleLaneMask = MoveMask(And(Select(isFullV, hasRecordV, isTouchedV), insideBoxV));
+					}
+
+					if (MoveMask(coverage) == 0 && sampleLaneMask == 0)
+					{
+						if (isWholeBlock)
+						{
+							blockMaxDepthV = Max(blockMaxDepthV, LoadHiZDepth(index, nrLanes));
+						}
+						continue;
+					}
+
+					const FloatV interpolatedDepth = Add(Add(Mul(weightV0, depthV0V), Mul(weightV1, depthV1V)), Mul(weightV2, depthV2V));
+
+					FloatV passed = TestAndWriteDepth(interpolatedDepth, AsFloat(coverage), index, nrLanes, blockMaxDepthV);
+					int passedMask = MoveMask(passed);
+
+					//Pixels on an edge are tested sample by sample, they are still shaded once
+					int samplePassedMask{ 0 };
+					uint32_t passedSamples[LANES]{};
+					if (sampleLaneMask != 0)
+					{
+						float centerDepths[LANES];
+						uint32_t sampleMasks[LANES];
+						uint32_t collapsedLanes[LANES]{};
+						Store(centerDepths, interpolatedDepth);
+						Store(sampleMasks, sampleMaskV);
+						for (int laneMask{ sampleLaneMask }; laneMask != 0; laneMask &= laneMask - 1)
+						{
+							const int lane = std::countr_zero(static_cast<uint32_t>(laneMask));
+							bool isCollapsed{ false };
+							passedSamples[lane] = TestSamples(tile, index + lane, sampleMasks[lane], centerDepths[lane], sampleDepthOffsets, isCollapsed);
+							if (isCollapsed)
+							{
+								collapsedLanes[lane] = ~0u;
+							}
+							else if (passedSamples[lane] != 0)
+							{
+								samplePassedMask |= 1 << lane;
+							}
+						}
+
+						//A pixel whose samples were all won is written like a fully covered one
+						passed = Or(passed, AsFloat(Load(collapsedLanes)));
+						passedMask = MoveMask(passed);
+					}
+
+					if (passedMask == 0 && samplePassedMask == 0)
+					{
+						continue;
+					}
+					isDepthWritten = true;
+
+					//Remember which triangle won, shading waits until all triangles are drawn
+					if (m_IsVisibilityBuffer)
+					{
+						uint32_t* pVisibility = m_pVisibilityBufferPixels + index;
+						const IntV storedIds = nrLanes == LANES ? Load(pVisibility) : LoadPartial(pVisibility, nrLanes);
+						const IntV newIds = Select(AsInt(passed), visibilityIdV, storedIds);
+						if (nrLanes == LANES)
+						{
+							Store(pVisibility, newIds);
+						}
+						else
+						{
+							StorePartial(pVisibility, newIds, nrLanes);
+						}
+						continue;
+					}
+
+					//Perspective correct UV for all lanes at once, with its change per pixel for the texture LOD
+					FloatV uV{}, vV{};
+					float uGradientX[LANES], vGradientX[LANES], uGradientY[LANES], vGradientY[LANES];
+					if (!m_IsDepthBuffer)
+					{
+						//The center of a pixel on an edge can be outside the triangle, keep the attributes inside it like centroid sampling
+						if (isCoverageAA)
+						{
+							const FloatV zeroWeightV = Set1(0.f);
+							weightV0 = Max(weightV0, zeroWeightV);
+							weightV1 = Max(weightV1, zeroWeightV);
+							weightV2 = Max(weightV2, zeroWeightV);
+							const FloatV invWeightSumV = Div(oneV, Add(Add(weightV0, weightV1), weightV2));
+							weightV0 = Mul(weightV0, invWeightSumV);
+							weightV1 = Mul(weightV1, invWeightSumV);
+							weightV2 = Mul(weightV2, invWeightSumV);
+						}
+						const FloatV interpolatedPixelDepth = Div(oneV, Add(Add(Mul(weightV0, invW0V), Mul(weightV1, invW1V)), Mul(weightV2, invW2V)));
+						uV = Mul(Add(Add(Mul(weightV0, u0V), Mul(weightV1, u1V)), Mul(weightV2, u2V)), interpolatedPixelDepth);
+						vV = Mul(Add(Add(Mul(weightV0, v0V), Mul(weightV1, v1V)), Mul(weightV2, v2V)), interpolatedPixelDepth);
+
+						//Quotient rule, (d(uv / w) - uv * d(1 / w)) * w
+						Store(uGradientX, Mul(Sub(uGradientXV, Mul(uV, invWGradientXV)), interpolatedPixelDepth));
+						Store(vGradientX, Mul(Sub(vGradientXV, Mul(vV, invWGradientXV)), interpolatedPixelDepth));
+						Store(uGradientY, Mul(Sub(uGradientYV, Mul(uV, invWGradientYV)), interpolatedPixelDepth));
+						Store(vGradientY, Mul(Sub(vGradientYV, Mul(vV, invWGradientYV)), interpolatedPixelDepth));
+					}
+
+					//Shade all lanes at once, the ones that didn't pass are discarded by the select below
+					FloatV pixelRed = Set1(0.f), pixelGreen = Set1(0.f), pixelBlue = Set1(0.f);
+					if (!m_IsDepthBuffer && !pTexture)
+					{
+						pixelRed = pixelGreen = pixelBlue = oneV;
+					}
+					else if (!m_IsDepthBuffer)
+					{
+						//The span shares one LOD like a quad on a GPU, from the largest change of uv among its shaded lanes
+						Vector2 maxGradientX{}, maxGradientY{};
+						for (int laneMask{ passedMask | samplePassedMask }; laneMask != 0; laneMask &= laneMask - 1)
+						{
+							const int lane = std::countr_zero(static_cast<uint32_t>(laneMask));
+							maxGradientX.x = std::max(maxGradientX.x, std::abs(uGradientX[lane]));
+							maxGradientX.y = std::max(maxGradientX.y, std::abs(vGradientX[lane]));
+							maxGradientY.x = std::max(maxGradientY.x, std::abs(uGradientY[lane]));
+							maxGradientY.y = std::max(maxGradientY.y, std::abs(vGradientY[lane]));
+						}
+						const int mipLevel = pTexture->GetMipLevel(maxGradientX, maxGradientY);
+
+						pTexture->Sample(m_Sampler, uV, vV, mipLevel, pixelRed, pixelGreen, pixelBlue);
+					}
+
+					//Update Color in Buffer
+					uint32_t* pPixels = m_pColorBufferPixels + index;
+					const IntV colors = PackColors(pixelRed, pixelGreen, pixelBlue);
+					const IntV storedColors = nrLanes == LANES ? Load(pPixels) : LoadPartial(pPixels, nrLanes);
+					const IntV newColors = Select(AsInt(passed), colors, storedColors);
+					if (nrLanes == LANES)
+					{
+						Store(pPixels, newColors);
+					}
+					else
+					{
+						StorePartial(pPixels, newColors, nrLanes);
+					}
+
+					if (samplePassedMask != 0)
+					{
+						uint32_t laneColors[LANES];
+						Store(laneColors, colors);
+						for (int laneMask{ samplePassedMask }; laneMask != 0; laneMask &= laneMask - 1)
+						{
+							const int lane = std::countr_zero(static_cast<uint32_t>(laneMask));
+							WriteSamples(tile, index + lane, passedSamples[lane], laneColors[lane]);
+						}
+					}
+				}
+			}
+
+			if (isDepthWritten && isWholeBlock)
+			{
+				m_pHiZBufferPixels[hiZIndex] = ReduceMax(blockMaxDepthV);
+			}
+		}
+	}
+}
+
+simd::FloatV dae::Renderer::TestAndWriteDepth(simd::FloatV depth, simd::FloatV coverage, int index, int nrLanes, simd::FloatV& farthestDepth)
+{
+	using namespace simd;
+
+	//Pixels beyond the far plane are dropped here instead of clipping the triangle
+	const bool isReversed = m_DepthFormat == DepthFormat::ReversedFloat32;
+	const FloatV inRange = And(coverage, CmpLE(depth, Set1(isReversed ? 0.f : 1.f)));
+
+	if (m_DepthFormat == DepthFormat::Float32 || isReversed)
+	{
+		float* pDepth = m_pDepthBufferPixels + index;
+		const FloatV storedDepth = nrLanes == LANES ? Load(pDepth) : LoadPartial(pDepth, nrLanes, -FLT_MAX);
+		const FloatV passed = And(inRange, CmpLE(depth, storedDepth));
+		const FloatV newDepth = Select(passed, depth, storedDepth);
+		farthestDepth = Max(farthestDepth, newDepth);
+
+		if (MoveMask(passed) != 0)
+		{
+			if (nrLanes == LANES)
+			{
+				Store(pDepth, newDepth);
+			}
+			else
+			{
+				StorePartial(pDepth, newDepth, nrLanes);
+			}
+		}
+		return passed;
+	}
+
+	//Round to the nearest step, equal steps pass like equal floats do
+	const bool is16Bit = m_DepthFormat == DepthFormat::Unorm16;
+	const float maxValue = static_cast<float>(is16Bit ? DEPTH16_MAX : DEPTH24_MAX);
+	const IntV newValue = ToInt(Add(Mul(Min(Max(depth, Set1(0.f)), Set1(1.f)), Set1(maxValue)), Set1(0.5f)));
+
+	IntV storedValue;
+	if (is16Bit)
+	{
+		storedValue = nrLanes == LANES ? Load(m_pDepth16BufferPixels + index) : LoadPartial(m_pDepth16BufferPixels + index, nrLanes);
+	}
+	else
+	{
+		storedValue = nrLanes == LANES ? Load(m_pDepth24BufferPixels + index) : LoadPartial(m_pDepth24BufferPixels + index, nrLanes);
+	}
+
+	const IntV oneV = Set1(1);
+	const FloatV passed = And(inRange, AsFloat(CmpLT(newValue, Add(storedValue, oneV))));
+	const IntV resultValue = Select(AsInt(passed), newValue, storedValue);
+
+	//The Hi-Z buffer gets the upper end of the step, a depth that rounds down to the stored value is never culled
+	farthestDepth = Max(farthestDepth, Mul(ToFloat(Add(resultValue, oneV)), Set1(1.f / maxValue)));
+
+	if (MoveMask(passed) != 0)
+	{
+		if (is16Bit)
+		{
+			if (nrLanes == LANES)
+			{
+				Store(m_pDepth16BufferPixels + index, resultValue);
+			}
+			else
+			{
+				StorePartial(m_pDepth16BufferPixels + index, resultValue, nrLanes);
+			}
+		}
+		else
+		{
+			if (nrLanes == LANES)
+			{
+				Store(m_pDepth24BufferPixels + index, resultValue);
+			}
+			else
+			{
+				StorePartial(m_pDepth24BufferPixels + index, resultValue, nrLanes);
+			}
+		}
+	}
+	return passed;
+}
+
+uint32_t dae::Renderer::TestSamples(Tile& tile, int index, uint32_t coverageMask, float centerDepth, const float* pSampleDepthOffsets, bool& isCollapsed)
+{
+	const uint32_t allSamples = (1u << m_SampleCount) - 1;
+	const float farLimit = m_DepthFormat == DepthFormat::ReversedFloat32 ? 0.f : 1.f;
+
+	//Without a record every sample has the depth of the pixel
+	uint32_t recordIndex = m_pSampleRecordIndices[index];
+	const float pixelDepth = recordIndex == EMPTY_SAMPLE_RECORD ? LoadPixelDepth(index) : 0.f;
+
+	float sampleDepths[MAX_SAMPLE_COUNT]{};
+	uint32_t passedMask{};
+	for (int sample = 0; sample < m_SampleCount; ++sample)
+	{
+		if ((coverageMask & (1u << sample)) == 0)
+		{
+			continue;
+		}
+
+		sampleDepths[sample] = centerDepth + pSampleDepthOffsets[sample];
+		const float storedDepth = recordIndex == EMPTY_SAMPLE_RECORD ? pixelDepth : tile.pSampleRecords[recordIndex].depths[sample];
+		if (sampleDepths[sample] <= storedDepth && sampleDepths[sample] <= farLimit)
+		{
+			passedMask |= 1u << sample;
+		}
+	}
+
+	if (passedMask == 0)
+	{
+		return 0;
+	}
+
+	//The triangle is in front everywhere in the pixel, one color and depth are enough again
+	if (passedMask == allSamples)
+	{
+		if (recordIndex != EMPTY_SAMPLE_RECORD)
+		{
+			SampleRecord& record = tile.pSampleRecords[recordIndex];
+			record.pixelIndex = EMPTY_SAMPLE_RECORD;
+			record.colors[0] = tile.freeSampleRecord;
+			tile.freeSampleRecord = recordIndex;
+			m_pSampleRecordIndices[index] = EMPTY_SAMPLE_RECORD;
+		}
+		StorePixelDepth(index, centerDepth);
+		isCollapsed = true;
+		return passedMask;
+	}
+
+	//Give the pixel its own samples, they start as copies of the pixel
+	if (recordIndex == EMPTY_SAMPLE_RECORD)
+	{
+		if (tile.freeSampleRecord != EMPTY_SAMPLE_RECORD)
+		{
+			recordIndex = tile.freeSampleRecord;
+			tile.freeSampleRecord = tile.pSampleRecords[recordIndex].colors[0];
+		}
+		else
+		{
+			//The pool is full, the pixel is skipped and the tile drawn again with a larger pool
+			++tile.nrSampleRecordsNeeded;
+			if (tile.nrSampleRecords == tile.sampleRecordCapacity)
+			{
+				return 0;
+			}
+			recordIndex = tile.nrSampleRecords++;
+		}
+		m_pSampleRecordIndices[index] = recordIndex;
+
+		SampleRecord& record = tile.pSampleRecords[recordIndex];
+		record.pixelIndex = static_cast<uint32_t>(index);
+		std::fill_n(record.colors, m_SampleCount, m_pColorBufferPixels[index]);
+		std::fill_n(record.depths, m_SampleCount, pixelDepth);
+	}
+
+	//The pixel keeps the farthest sample, so the Hi-Z buffer stays conservative
+	SampleRecord& record = tile.pSampleRecords[recordIndex];
+	float farthestDepth{ -FLT_MAX };
+	for (int sample = 0; sample < m_SampleCount; ++sample)
+	{
+		if (passedMask & (1u << sample))
+		{
+			record.depths[sample] = sampleDepths[sample];
+		}
+		farthestDepth = std::max(farthestDepth, record.depths[sample]);
+	}
+	StorePixelDepth(index, farthestDepth);
+
+	return passedMask;
+}
+
+void dae::Renderer::WriteSamples(const Tile& tile, int index, uint32_t sampleMask, uint32_t color)
+{
+	SampleRecord& record = tile.pSampleRecords[m_pSampleRecordIndices[index]];
+	for (int sample = 0; sample < m_SampleCount; ++sample)
+	{
+		if (sampleMask & (1u << sample))
+		{
+			record.colors[sample] = color;
+		}
+	}
+}
+
+void dae::Renderer::ResolveSamples(const Tile& tile)
+{
+	const SampleRecord* pRecords = tile.pSampleRecords;
+	const uint32_t halfSampleCount = static_cast<uint32_t>(m_SampleCount / 2);
+
+	for (uint32_t i = 0; i < tile.nrSampleRecords; ++i)
+	{
+		const SampleRecord& record = pRecords[i];
+		if (record.pixelIndex == EMPTY_SAMPLE_RECORD)
+		{
+			continue;
+		}
+
+		uint32_t red{}, green{}, blue{};
+		for (int sample = 0; sample < m_SampleCount; ++sample)
+		{
+			red += (record.colors[sample] >> m_RedShift) & 0xFF;
+			green += (record.colors[sample] >> m_GreenShift) & 0xFF;
+			blue += (record.colors[sample] >> m_BlueShift) & 0xFF;
+		}
+
+		const uint32_t sampleCount = static_cast<uint32_t>(m_SampleCount);
+		m_pColorBufferPixels[record.pixelIndex] = ((red + halfSampleCount) / sampleCount) << m_RedShift
+			| ((green + halfSampleCount) / sampleCount) << m_GreenShift
+			| ((blue + halfSampleCount) / sampleCount) << m_BlueShift
+			| m_AlphaMask;
+	}
+}
+
+float dae::Renderer::LoadPixelDepth(int index) const
+{
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::Unorm16:
+		return static_cast<float>(m_pDepth16BufferPixels[index]) / static_cast<float>(DEPTH16_MAX);
+	case DepthFormat::Fixed24:
+		return static_cast<float>(m_pDepth24BufferPixels[index]) / static_cast<float>(DEPTH24_MAX);
+	default:
+		return m_pDepthBufferPixels[index];
+	}
+}
+
+void dae::Renderer::StorePixelDepth(int index, float depth)
+{
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::Unorm16:
+		m_pDepth16BufferPixels[index] = static_cast<uint16_t>(std::lrint(std::clamp(depth, 0.f, 1.f) * static_cast<float>(DEPTH16_MAX)));
+		break;
+	case DepthFormat::Fixed24:
+		m_pDepth24BufferPixels[index] = static_cast<uint32_t>(std::lrint(std::clamp(depth, 0.f, 1.f) * static_cast<float>(DEPTH24_MAX)));
+		break;
+	default:
+		m_pDepthBufferPixels[index] = depth;
+		break;
+	}
+}
+
+simd::FloatV dae::Renderer::LoadHiZDepth(int index, int nrLanes) const
+{
+	using namespace simd;
+
+	IntV storedValue;
+	switch (m_DepthFormat)
+	{
+	case DepthFormat::Unorm16:
+		storedValue = nrLanes == LANES ? Load(m_pDepth16BufferPixels + index) : LoadPartial(m_pDepth16BufferPixels + index, nrLanes);
+		return Mul(ToFloat(Add(storedValue, Set1(1))), Set1(1.f / static_cast<float>(DEPTH16_MAX)));
+	case DepthFormat::Fixed24:
+		storedValue = nrLanes == LANES ? Load(m_pDepth24BufferPixels + index) : LoadPartial(m_pDepth24BufferPixels + index, nrLanes);
+		return Mul(ToFloat(Add(storedValue, Set1(1))), Set1(1.f / static_cast<float>(DEPTH24_MAX)));
+	default:
+		return nrLanes == LANES ? Load(m_pDepthBufferPixels + index) : LoadPartial(m_pDepthBufferPixels + index, nrLanes, -FLT_MAX);
+	}
+}
+
+void dae::Renderer::ResolveTile(const Tile& tile)
+{
+	using namespace simd;
+
+	const int64_t halfPixel = SUBPIXEL_SCALE / 2;
+
+	for (int py{ tile.minY }; py < tile.maxY; ++py)
+	{
+		//Tiles start at a multiple of LANES, only the last block of the screen can be partial
+		for (int px{ tile.minX }; px < tile.maxX; px += LANES)
+		{
+			const int index = GetPixelIndex(px, py);
+			const int nrLanes = std::min(LANES, tile.maxX - px);
+			uint32_t isShaded[LANES]{};
+			int shadeMask{};
+			float pixelU[LANES]{}, pixelV[LANES]{};
+			Vector2 uvGradientsX[LANES]{}, uvGradientsY[LANES]{};
+			uint32_t visibilityIds[LANES]{};
+
+			for (int lane = 0; lane < nrLanes; ++lane)
+			{
+				const uint32_t visibilityId = m_pVisibilityBufferPixels[index + lane];
+				if (visibilityId == EMPTY_VISIBILITY_ID)
+				{
+					continue;
+				}
+				isShaded[lane] = ~0u;
+				if (m_IsDepthBuffer)
+				{
+					continue;
+				}
+
+				//Same edge equations the rasterizer used, so the weights match exactly
+				const TriangleSetup& setup = m_TriangleSetups[visibilityId];
+				shadeMask |= 1 << lane;
+				visibilityIds[lane] = visibilityId;
+				const int64_t pointX = (static_cast<int64_t>(px + lane) << SUBPIXEL_BITS) + halfPixel;
+				const int64_t pointY = (static_cast<int64_t>(py) << SUBPIXEL_BITS) + halfPixel;
+				const float weightV0 = static_cast<float>(setup.a[0] * pointX + setup.b[0] * pointY + setup.c[0]) * setup.invArea;
+				const float weightV1 = static_cast<float>(setup.a[1] * pointX + setup.b[1] * pointY + setup.c[1]) * setup.invArea;
+				const float weightV2 = static_cast<float>(setup.a[2] * pointX + setup.b[2] * pointY + setup.c[2]) * setup.invArea;
+
+				const float interpolatedPixelDepth
+				{
+					1.f /
+					(
+						weightV0 * setup.invW[0] +
+						weightV1 * setup.invW[1] +
+						weightV2 * setup.invW[2]
+					)
+				};
+
+				const Vector2 pixelUV{ (weightV0 * setup.uv[0] + weightV1 * setup.uv[1] + weightV2 * setup.uv[2]) * interpolatedPixelDepth };
+
+				pixelU[lane] = pixelUV.x;
+				pixelV[lane] = pixelUV.y;
+
+				uvGradientsX[lane] = (setup.uvGradientX - pixelUV * setup.invWGradientX) * interpolatedPixelDepth;
+				uvGradientsY[lane] = (setup.uvGradientY - pixelUV * setup.invWGradientY) * interpolatedPixelDepth;
+			}
+
+			//The lanes can belong to different triangles. The texture of every triangle in the span is sampled once for all lanes
+			//and kept for the lanes of that triangle, with the LOD from those lanes only, like the forward path picks it
+			FloatV pixelRed = Set1(0.f), pixelGreen = Set1(0.f), pixelBlue = Set1(0.f);
+			while (shadeMask != 0)
+			{
+				const uint32_t visibilityId = visibilityIds[std::countr_zero(static_cast<uint32_t>(shadeMask))];
+				const Texture* pTexture = GetDiffuseTexture(m_TriangleSetups[visibilityId].material);
+				uint32_t isTriangleLane[LANES]{};
+				Vector2 maxGradientX{}, maxGradientY{};
+				for (int laneMask{ shadeMask }; laneMask != 0; laneMask &= laneMask - 1)
+				{
+					const int lane = std::countr_zero(static_cast<uint32_t>(laneMask));
+					if (visibilityIds[lane] != visibilityId)
+					{
+						continue;
+					}
+
+					isTriangleLane[lane] = ~0u;
+					shadeMask &= ~(1 << lane);
+					maxGradientX.x = std::max(maxGradientX.x, std::abs(uvGradientsX[lane].x));
+					maxGradientX.y = std::max(maxGradientX.y, std::abs(uvGradientsX[lane].y));
+					maxGradientY.x = std::max(maxGradientY.x, std::abs(uvGradientsY[lane].x));
+					maxGradientY.y = std::max(maxGradientY.y, std::abs(uvGradientsY[lane].y));
+				}
+
+				FloatV textureRed = Set1(1.f), textureGreen = Set1(1.f), textureBlue = Set1(1.f);
+				if (pTexture)
+				{
+					const int mipLevel = pTexture->GetMipLevel(maxGradientX, maxGradientY);
+					pTexture->Sample(m_Sampler, Load(pixelU), Load(pixelV), mipLevel, textureRed, textureGreen, textureBlue);
+				}
+
+				const FloatV isTriangleLaneV = AsFloat(Load(isTriangleLane));
+				pixelRed = Select(isTriangleLaneV, textureRed, pixelRed);
+				pixelGreen = Select(isTriangleLaneV, textureGreen, pixelGreen);
+				pixelBlue = Select(isTriangleLaneV, textureBlue, pixelBlue);
+			}
+
+			//Update Color in Buffer
+			uint32_t* pPixels = m_pColorBufferPixels + index;
+			const IntV colors = PackColors(pixelRed, pixelGreen, pixelBlue);
+			const IntV storedColors = nrLanes == LANES ? Load(pPixels) : LoadPartial(pPixels, nrLanes);
+			const IntV newColors = Select(Load(isShaded), colors, storedColors);
+			if (nrLanes == LANES)
+			{
+				Store(pPixels, newColors);
+			}
+			else
+			{
+				StorePartial(pPixels, newColors, nrLanes);
+			}
+		}
+	}
+}
+
+simd::IntV dae::Renderer::PackColors(simd::FloatV red, simd::FloatV green, simd::FloatV blue) const
+{
+	using namespace simd;
+
+	const FloatV oneV = Set1(1.f);
+	const FloatV maxChannelV = Set1(255.f);
+
+	//Dividing by one leaves the colors that are in range untouched
+	const FloatV scale = Max(Max(red, Max(green, blue)), oneV);
+	const IntV redV = ToInt(Mul(Div(red, scale), maxChannelV));
+	const IntV greenV = ToInt(Mul(Div(green, scale), maxChannelV));
+	const IntV blueV = ToInt(Mul(Div(blue, scale), maxChannelV));
+
+	return Or(Or(ShiftLeft(redV, m_RedShift), ShiftLeft(greenV, m_GreenShift)), Or(ShiftLeft(blueV, m_BlueShift), Set1(static_cast<int32_t>(m_AlphaMask))));
+}
+
+uint32_t dae::Renderer::GetHiZCulledBlockCount() const
+{
+	//Tiles without triangles weren't drawn and still hold an older count
+	uint32_t count{};
+	for (const Tile& tile : m_Tiles)
+	{
+		if (!tile.triangles.empty())
+		{
+			count += tile.nrHiZCulledBlocks;
+		}
+	}
+	return count;
+}
+
+bool Renderer::SaveBufferToImage(const std::string& path) const
+{
+	//Saving reads the back buffer, which the render target can still be using until its fence
+	const int lastBackBufferIndex = (m_BackBufferIndex + BACK_BUFFER_COUNT - 1) % BACK_BUFFER_COUNT;
+	m_pRenderTarget->WaitForFence(m_BackBufferFences[lastBackBufferIndex]);
+
+	//SDL's RGB888 is XRGB8888, the surface only wraps the pixels
+	SDL_Surface* pSurface = SDL_CreateRGBSurfaceWithFormatFrom(m_pBackBufferPixels, m_Width, m_Height, 32, m_Width * static_cast<int>(sizeof(uint32_t)), SDL_PIXELFORMAT_RGB888);
+	if (!pSurface)
+	{
+		return true;
+	}
+
+	//Like SDL_SaveBMP, true means the image wasn't saved
+	const int result = SDL_SaveBMP(pSurface, path.c_str());
+	SDL_FreeSurface(pSurface);
+	return result != 0;
 }
\ No newline at end of file
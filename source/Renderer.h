@@ -6,9 +6,9 @@
 
 #include "Camera.h"
 #include "DataTypes.h"
+#include "MaterialCache.h"
+#include "Texture.h"
 
-struct SDL_Window;
-struct SDL_Surface;
 
 namespace dae
 {
@@ -17,11 +17,24 @@ namespace dae
 	struct Vertex;
 	class Timer;
 	class Scene;
+	class ThreadPool;
+	class RenderTarget;
+
+	//Storage of the depth buffer. The integer formats quantize z / w, reversed-Z keeps a float that is 1 at the near plane and 0 at the far plane
+	enum class DepthFormat
+	{
+		Float32,
+		Unorm16,
+		Fixed24,
+		ReversedFloat32
+	};
 
 	class Renderer final
 	{
 	public:
-		Renderer(SDL_Window* pWindow);
+		//The render target isn't owned, it has to outlive the renderer
+		//nrThreads 0 uses every hardware thread, 1 rasterizes on the calling thread only
+		Renderer(RenderTarget* pRenderTarget, uint32_t nrThreads = 0);
 		~Renderer();
 
 		Renderer(const Renderer&) = delete;
@@ -30,54 +43,303 @@ namespace dae
 		Renderer& operator=(Renderer&&) noexcept = delete;
 
 		void Update(Timer* pTimer);
+		//Puts the scene in its state at a time since the start, without the input and frame time Update depends on
+		void SetSceneTime(float seconds);
+		void SetCameraPose(const Vector3& origin, float pitch, float yaw);
 		void Render();
 		void ToggleDepthBuffer();
+		void ToggleVisibilityBuffer();
+		void ToggleSwizzledLayout();
+		void SetDepthFormat(DepthFormat format);
+		void CycleDepthFormat();
+		//Lowers the render resolution when frames take longer than the target frame time, the frame is stretched over the window
+		void ToggleDynamicResolution();
+		//Coverage anti-aliasing with 1 (off), 4 or 8 samples per pixel, every pixel is still shaded once per triangle
+		void CycleSampleCount();
+		void SetTargetFrameTime(float seconds);
+		//Switches textures between point sampling and bilinear filtering
+		void ToggleTextureFilter();
+		void SetSampler(const Sampler& sampler);
 
-		bool SaveBufferToImage() const;
+		bool SaveBufferToImage(const std::string& path = "Rasterizer_ColorBuffer.bmp") const;
+
+		//Hi-Z blocks a triangle of the last frame was skipped in, because it was behind everything already drawn there
+		uint32_t GetHiZCulledBlockCount() const;
 
 	private:
-		SDL_Window* m_pWindow{};
+		struct SampleRecord;
+
+		//Screen region that is rasterized by one worker at a time
+		struct Tile
+		{
+			int minX{};
+			int minY{};
+			int maxX{};
+			int maxY{};
+
+			//Lives in the frame arena
+			ArenaVector<uint32_t> triangles{};
+
+			//Buffers are cleared the first time a triangle touches the tile in a frame
+			bool isCleared{ false };
+			uint32_t nrHiZCulledBlocks{};
+
+			//Sample records of this frame, in the frame arena. Records of pixels that went back to a single sample are reused first,
+			//they are linked through colors[0]
+			SampleRecord* pSampleRecords{};
+			uint32_t nrSampleRecords{};
+			uint32_t freeSampleRecord{ UINT32_MAX };
+			//Size of the pool, grows with the records the tile needed in earlier frames
+			//Needed is larger than handed out when the pool ran out, the tile is drawn again then
+			uint32_t sampleRecordCapacity{};
+			uint32_t nrSampleRecordsNeeded{};
+		};
+
+		//Everything the rasterizer needs of a triangle, computed once before binning
+		struct TriangleSetup
+		{
+			//Edge equations a * x + b * y + c in sub-pixel units, positive on the inside
+			//Every edge is named after the vertex opposite of it, which is also the weight it gives
+			int64_t a[3]{};
+			int64_t b[3]{};
+			int64_t c[3]{};
+			//Top-left rule, subtracted again before the edge value is used as a weight
+			int32_t bias[3]{};
+			float invArea{};
+
+			//Pixels whose center can be inside the triangle, clamped to the screen
+			int minX{};
+			int minY{};
+			int maxX{};
+			int maxY{};
+
+			//Depth is interpolated linearly, uv divided by w for perspective correction
+			float depth[3]{};
+			float invW[3]{};
+			Vector2 uv[3]{};
+			float minDepth{};
+
+			//Change of the interpolated uv / w and 1 / w from one pixel to the next, the texture LOD follows from it
+			Vector2 uvGradientX{};
+			Vector2 uvGradientY{};
+			float invWGradientX{};
+			float invWGradientY{};
+
+			MaterialHandle material{ INVALID_MATERIAL };
+		};
+
+		static constexpr int TILE_SIZE{ 64 };
+
+		//Sample positions of coverage AA in sub-pixel units from the pixel center, the standard 4x and 8x patterns
+		static constexpr int MAX_SAMPLE_COUNT{ 8 };
+		static constexpr int MAX_SAMPLE_OFFSET{ 7 };
+		static constexpr int SAMPLE_OFFSETS_4X[4][2]{ { -2, -6 }, { 6, -2 }, { -6, 2 }, { 2, 6 } };
+		static constexpr int SAMPLE_OFFSETS_8X[8][2]{ { 1, -3 }, { -1, 3 }, { 5, 1 }, { -3, -5 }, { -5, 5 }, { -7, -1 }, { 3, 7 }, { 7, -7 } };
+		static constexpr uint32_t EMPTY_SAMPLE_RECORD{ UINT32_MAX };
+		//Pool of a tile the first frame it is drawn with AA, a quarter of its pixels
+		static constexpr uint32_t MIN_SAMPLE_RECORDS{ TILE_SIZE * TILE_SIZE / 4 };
+
+		//Color and depth of every sample of a pixel that is shared by more than one triangle
+		//Pixels covered by a single triangle don't have one and cost the same as without AA
+		struct SampleRecord
+		{
+			uint32_t pixelIndex{};
+			uint32_t colors[MAX_SAMPLE_COUNT]{};
+			float depths[MAX_SAMPLE_COUNT]{};
+		};
+
+		//Every HIZ_BLOCK_SIZE x HIZ_BLOCK_SIZE block of pixels keeps the farthest depth stored in it
+		static constexpr int HIZ_BLOCK_SIZE{ 8 };
+		static_assert(TILE_SIZE % HIZ_BLOCK_SIZE == 0, "Hi-Z blocks can't be shared by tiles");
+
+		static constexpr uint32_t EMPTY_VISIBILITY_ID{ UINT32_MAX };
+
+		//Largest value of the integer depth formats, also their clear value
+		static constexpr uint32_t DEPTH16_MAX{ 0xFFFF };
+		static constexpr uint32_t DEPTH24_MAX{ 0xFFFFFF };
+
+		//Clip codes of a vertex in homogeneous clip space, the guard band bits mark positions the rasterizer can't take
+		static constexpr uint32_t CLIP_LEFT{ 1 << 0 };
+		static constexpr uint32_t CLIP_RIGHT{ 1 << 1 };
+		static constexpr uint32_t CLIP_BOTTOM{ 1 << 2 };
+		static constexpr uint32_t CLIP_TOP{ 1 << 3 };
+		static constexpr uint32_t CLIP_NEAR{ 1 << 4 };
+		static constexpr uint32_t CLIP_FAR{ 1 << 5 };
+		static constexpr uint32_t CLIP_GUARD_BAND{ 1 << 6 };
+
+		//Triangles are rasterized without clipping as long as they stay within this many viewports around the screen
+		static constexpr float GUARD_BAND_SCALE{ 256.f };
+
+		//Vertices are snapped to 1/16th of a pixel before rasterization
+		static constexpr int SUBPIXEL_BITS{ 4 };
+		static constexpr int SUBPIXEL_SCALE{ 1 << SUBPIXEL_BITS };
 
-		SDL_Surface* m_pFrontBuffer{ nullptr };
-		SDL_Surface* m_pBackBuffer{ nullptr };
+		//Ring of back buffers, one is rasterized while the previous ones wait for or are being presented
+		static constexpr int BACK_BUFFER_COUNT{ 3 };
+		uint32_t* m_pBackBuffers[BACK_BUFFER_COUNT]{};
+		uint64_t m_BackBufferFences[BACK_BUFFER_COUNT]{};
+		int m_BackBufferIndex{};
+		RenderTarget* m_pRenderTarget{ nullptr };
+
+		//Back buffer of the current frame
 		uint32_t* m_pBackBufferPixels{};
 
+		//Linear color at the render resolution, the back buffer itself unless the resolution is scaled
+		uint32_t* m_pRenderTargetPixels{};
+		uint32_t* m_pScaledColorBufferPixels{};
+
+		//Channel positions of the back buffer format
+		int m_RedShift{};
+		int m_GreenShift{};
+		int m_BlueShift{};
+		uint32_t m_AlphaMask{};
+
+		uint32_t m_ClearColor{};
+
+		//Color the pixel kernels write to, the back buffer itself or the swizzled buffer that is copied to it per tile
+		uint32_t* m_pColorBufferPixels{};
+		uint32_t* m_pSwizzledColorBufferPixels{};
+
+		//Only the buffer of the current depth format is allocated
+		//Reversed-Z is stored negated, so closer is smaller in every format and the Hi-Z buffer doesn't change
+		DepthFormat m_DepthFormat{ DepthFormat::Float32 };
+		int m_DepthBufferSize{};
 		float* m_pDepthBufferPixels{};
+		uint16_t* m_pDepth16BufferPixels{};
+		uint32_t* m_pDepth24BufferPixels{};
+
+		float* m_pHiZBufferPixels{};
+		int m_HiZWidth{};
+		int m_HiZHeight{};
+
+		//Id of the visible triangle per pixel, only filled when shading is deferred to the resolve pass
+		uint32_t* m_pVisibilityBufferPixels{};
+
+		//Coverage AA, allocated the first time it is enabled. Every pixel has the index of its sample record in the pool of its tile or EMPTY_SAMPLE_RECORD
+		//Deferred shading has no per sample visibility, so AA only applies while the visibility buffer is off
+		int m_SampleCount{ 1 };
+		uint32_t* m_pSampleRecordIndices{};
 
 		Camera m_Camera{};
 
-		Texture* m_pTexture{ nullptr };
+		MaterialCache m_MaterialCache{};
+		Sampler m_Sampler{};
 
+		//Window size
 		int m_Width{};
 		int m_Height{};
 		float m_AspectRatio{};
 
+		//Size that is rasterized, never larger than the window
+		int m_RenderWidth{};
+		int m_RenderHeight{};
+
+		//Dynamic resolution, the scale applies to both sides of the window
+		static constexpr float MIN_RESOLUTION_SCALE{ 0.5f };
+		static constexpr float FRAME_TIME_SMOOTHING{ 0.1f };
+		static constexpr float RESOLUTION_SCALE_RESPONSE{ 0.25f };
+		bool m_IsDynamicResolution{ false };
+		float m_TargetFrameTime{ 1.f / 60.f };
+		float m_AverageFrameTime{ 1.f / 60.f };
+		float m_ResolutionScale{ 1.f };
+		//Column of the render target every column of the window takes its pixel from
+		std::vector<uint32_t> m_UpscaleColumns{};
+
 		bool m_IsDepthBuffer{ false };
+		bool m_IsVisibilityBuffer{ false };
+		//Color, depth and visibility are stored per tile, per Hi-Z block in Z-order and row by row inside a block
+		bool m_IsSwizzledLayout{ false };
 
 		std::vector<Mesh> m_MeshesWorld{};
+		//World matrices at scene time 0
+		std::vector<Matrix> m_InitialWorldMatrices{};
+		//Radians per second the meshes turn around the Y axis
+		static constexpr float MESH_ROTATION_SPEED{ 1.f };
+
+		//Transformed vertices, triangle lists, setups and bin lists of the current frame
+		FrameArena m_FrameArena{};
+
+		ThreadPool* m_pThreadPool{ nullptr };
+		std::vector<Tile> m_Tiles{};
+		//Setups of all visible triangles of the frame, the index doubles as visibility id
+		ArenaVector<TriangleSetup> m_TriangleSetups{};
+		int m_TilesX{};
+		int m_TilesY{};
 
-		size_t m_VerticesCount{};
-		Vertex* m_VerticesWorld;
-		Vertex* m_VerticesNDC;
-		Vector2* m_VerticesScreenSpace;
-		//std::vector<Vertex> m_VerticesWorld{};
-		//std::vector<Vertex> m_VerticesNDC{};
-		//std::vector<Vector2> m_VerticesScreenSpace{};
 
 		//Create meshes
 		void CreateMeshes();
-		void LoadMesh(const std::string& path);
+		void LoadMesh(const std::string& path, const std::string& diffusePath);
+		//nullptr for meshes without a material or whose texture didn't load
+		const Texture* GetDiffuseTexture(MaterialHandle material) const;
+
+		//Tests the world space bounds against the camera frustum, before any per vertex work is done
+		bool IsMeshInFrustum(const Mesh& mesh) const;
+
+		//Split Mesh::vertices in the streams the pipeline reads
+		void CreateVertexStreams(Mesh& mesh);
+		//Transforms every unique vertex of the mesh once, LANES at a time, to homogeneous clip space and to the screen
+		void VertexTransformationWorldToScreen(Mesh& mesh);
+
+		//Primitive assembly: gathers the triangles through Mesh::indices, rejects the ones outside the frustum and clips the ones crossing the near plane
+		void AssembleTriangles(Mesh& mesh);
+		uint32_t GetClipCode(const Vector4& position) const;
+		void ClipTriangle(Mesh& mesh, uint32_t vertexIndex0, uint32_t vertexIndex1, uint32_t vertexIndex2);
+
+		//Triangle setup: drops back-facing, zero-area and too small triangles, the rest is added to m_TriangleSetups
+		void SetupTriangles(const Mesh& mesh);
+
+		//Steers the resolution scale towards the target frame time
+		void UpdateResolutionScale(float frameTime);
+		//Resizes the tiles and the Hi-Z buffer, the buffers are big enough for any size up to the window
+		void SetRenderResolution(int width, int height);
+		//Nearest neighbour stretch of the render target over rows [firstRow, endRow) of the back buffer
+		void UpscaleRows(uint32_t firstRow, uint32_t endRow);
+
+		//Split the screen in tiles and sort the triangle setups of the frame into the tiles they overlap
+		void CreateTiles();
+		void BinTriangles();
+		void RasterizeTile(Tile& tile);
+
+		//Reset color, depth, Hi-Z and visibility of the tile for a new frame
+		void ClearTile(Tile& tile);
+		//Fill a tile no triangle touched with the clear color, nothing else of it is read this frame
+		void FillTile(const Tile& tile);
+		//Copy a tile of the swizzled color buffer to the back buffer
+		void DetileTile(const Tile& tile);
+
+		//Position of a pixel in the color, depth and visibility buffers
+		//In the swizzled layout a row inside a Hi-Z block is contiguous, pixels of different blocks are not
+		int GetPixelIndex(int px, int py) const;
+
+		//Allocates the depth buffer of m_DepthFormat and frees the others
+		void CreateDepthBuffer();
+		//Depth test and write of LANES pixels in the current depth format, returns the lanes that passed
+		//farthestDepth is raised to the depths stored after the test, in the float units of the Hi-Z buffer
+		simd::FloatV TestAndWriteDepth(simd::FloatV depth, simd::FloatV coverage, int index, int nrLanes, simd::FloatV& farthestDepth);
+		//Stored depth of LANES pixels in the float units of the Hi-Z buffer
+		simd::FloatV LoadHiZDepth(int index, int nrLanes) const;
 
-		//Function that transforms the vertices from the mesh from World space to Screen space
-		void VertexTransformationWorldToNDC();
-		void VertexTransformationWorldToNDCNew(Mesh& mesh);
+		//Draw a triangle setup, only the pixels inside the tile are touched
+		//In visibility buffer mode only depth and visibilityId are written, the color follows in ResolveTile
+		void DrawTriangle(const TriangleSetup& setup, Tile& tile, uint32_t visibilityId);
 
-		bool IsVerticesInFrustrum(const Vertex_Out& vertex);
+		bool IsCoverageAA() const { return m_SampleCount > 1 && !m_IsVisibilityBuffer; }
+		//Depth test of the covered samples of one pixel that isn't covered completely, or already has a sample record
+		//Returns the samples the triangle won. When it won all of them the pixel goes back to a single color and depth and isCollapsed is set
+		//Without a free record in the tile the pixel is skipped, the tile has to be drawn again
+		uint32_t TestSamples(Tile& tile, int index, uint32_t coverageMask, float centerDepth, const float* pSampleDepthOffsets, bool& isCollapsed);
+		void WriteSamples(const Tile& tile, int index, uint32_t sampleMask, uint32_t color);
+		//Average the samples of every pixel with a record into the color buffer
+		void ResolveSamples(const Tile& tile);
+		//Depth of a single pixel, in [0, 1] for the integer formats
+		float LoadPixelDepth(int index) const;
+		void StorePixelDepth(int index, float depth);
 
-		//Draw traingles by using the index
-		void DrawTriangle(int index, bool swapVertices, const Mesh& mesh);
+		//Shade every pixel of the tile once, using the triangle stored in the visibility buffer
+		void ResolveTile(const Tile& tile);
 
-		//Find size to reserve
-		size_t FindReserveSize();
+		//Converts LANES colors to back buffer pixels, colors above one are scaled down like ColorRGB::MaxToOne
+		simd::IntV PackColors(simd::FloatV red, simd::FloatV green, simd::FloatV blue) const;
 	};
 }
@@ -0,0 +1,284 @@
+#pragma once
+//Thin wrapper around the widest instruction set the compiler targets (AVX2, SSE2 or plain scalar)
+//so the pixel kernels only have to be written once
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DAE_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DAE_SIMD_SSE2
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <vector>
+
+namespace dae
+{
+	namespace simd
+	{
+#if defined(DAE_SIMD_AVX2)
+		constexpr int LANES{ 8 };
+		using FloatV = __m256;
+		using IntV = __m256i;
+
+		inline FloatV Set1(float f) { return _mm256_set1_ps(f); }
+		inline IntV Set1(int32_t i) { return _mm256_set1_epi32(i); }
+		inline IntV LaneIndices() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+
+		inline FloatV Load(const float* p) { return _mm256_loadu_ps(p); }
+		inline IntV Load(const uint32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+		inline void Store(float* p, FloatV v) { _mm256_storeu_ps(p, v); }
+		inline void Store(uint32_t* p, IntV v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		//16 bit values are widened to a lane each, stores take the low 16 bits of lanes that fit in them
+		inline IntV Load(const uint16_t* p) { return _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+		inline void Store(uint16_t* p, IntV v)
+		{
+			//The pack works per 128 bit half, the permute puts both halves next to each other
+			const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0b1000);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm256_castsi256_si128(packed));
+		}
+
+		inline FloatV Add(FloatV a, FloatV b) { return _mm256_add_ps(a, b); }
+		inline FloatV Sub(FloatV a, FloatV b) { return _mm256_sub_ps(a, b); }
+		inline FloatV Mul(FloatV a, FloatV b) { return _mm256_mul_ps(a, b); }
+		inline FloatV Div(FloatV a, FloatV b) { return _mm256_div_ps(a, b); }
+		inline FloatV Min(FloatV a, FloatV b) { return _mm256_min_ps(a, b); }
+		inline FloatV Max(FloatV a, FloatV b) { return _mm256_max_ps(a, b); }
+		inline IntV Add(IntV a, IntV b) { return _mm256_add_epi32(a, b); }
+		inline IntV Sub(IntV a, IntV b) { return _mm256_sub_epi32(a, b); }
+
+		inline FloatV And(FloatV a, FloatV b) { return _mm256_and_ps(a, b); }
+		inline FloatV Or(FloatV a, FloatV b) { return _mm256_or_ps(a, b); }
+		inline IntV And(IntV a, IntV b) { return _mm256_and_si256(a, b); }
+		inline IntV Or(IntV a, IntV b) { return _mm256_or_si256(a, b); }
+		inline IntV ShiftLeft(IntV a, int count) { return _mm256_slli_epi32(a, count); }
+		inline IntV ShiftRight(IntV a, int count) { return _mm256_srli_epi32(a, count); }
+
+		inline FloatV CmpLE(FloatV a, FloatV b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		inline FloatV CmpGE(FloatV a, FloatV b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+		inline IntV CmpGT(IntV a, IntV b) { return _mm256_cmpgt_epi32(a, b); }
+		inline IntV CmpLT(IntV a, IntV b) { return _mm256_cmpgt_epi32(b, a); }
+
+		//Lanes of mask that are all ones take a, the others take b
+		inline FloatV Select(FloatV mask, FloatV a, FloatV b) { return _mm256_blendv_ps(b, a, mask); }
+		inline IntV Select(IntV mask, IntV a, IntV b) { return _mm256_blendv_epi8(b, a, mask); }
+
+		inline FloatV ToFloat(IntV v) { return _mm256_cvtepi32_ps(v); }
+		inline IntV ToInt(FloatV v) { return _mm256_cvttps_epi32(v); }
+		inline FloatV Floor(FloatV v) { return _mm256_floor_ps(v); }
+
+		inline IntV Gather(const uint32_t* p, IntV indices) { return _mm256_i32gather_epi32(reinterpret_cast<const int*>(p), indices, 4); }
+		inline FloatV AsFloat(IntV v) { return _mm256_castsi256_ps(v); }
+		inline IntV AsInt(FloatV v) { return _mm256_castps_si256(v); }
+
+		inline int MoveMask(FloatV mask) { return _mm256_movemask_ps(mask); }
+#elif defined(DAE_SIMD_SSE2)
+		constexpr int LANES{ 4 };
+		using FloatV = __m128;
+		using IntV = __m128i;
+
+		inline FloatV Set1(float f) { return _mm_set1_ps(f); }
+		inline IntV Set1(int32_t i) { return _mm_set1_epi32(i); }
+		inline IntV LaneIndices() { return _mm_setr_epi32(0, 1, 2, 3); }
+
+		inline FloatV Load(const float* p) { return _mm_loadu_ps(p); }
+		inline IntV Load(const uint32_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+		inline void Store(float* p, FloatV v) { _mm_storeu_ps(p, v); }
+		inline void Store(uint32_t* p, IntV v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+		//16 bit values are widened to a lane each, stores take the low 16 bits of lanes that fit in them
+		inline IntV Load(const uint16_t* p) { return _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), _mm_setzero_si128()); }
+		inline void Store(uint16_t* p, IntV v)
+		{
+			//SSE2 only packs with signed saturation, sign extending the low 16 bits first keeps them intact
+			const __m128i signExtended = _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+			_mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(signExtended, signExtended));
+		}
+
+		inline FloatV Add(FloatV a, FloatV b) { return _mm_add_ps(a, b); }
+		inline FloatV Sub(FloatV a, FloatV b) { return _mm_sub_ps(a, b); }
+		inline FloatV Mul(FloatV a, FloatV b) { return _mm_mul_ps(a, b); }
+		inline FloatV Div(FloatV a, FloatV b) { return _mm_div_ps(a, b); }
+		inline FloatV Min(FloatV a, FloatV b) { return _mm_min_ps(a, b); }
+		inline FloatV Max(FloatV a, FloatV b) { return _mm_max_ps(a, b); }
+		inline IntV Add(IntV a, IntV b) { return _mm_add_epi32(a, b); }
+		inline IntV Sub(IntV a, IntV b) { return _mm_sub_epi32(a, b); }
+
+		inline FloatV And(FloatV a, FloatV b) { return _mm_and_ps(a, b); }
+		inline FloatV Or(FloatV a, FloatV b) { return _mm_or_ps(a, b); }
+		inline IntV And(IntV a, IntV b) { return _mm_and_si128(a, b); }
+		inline IntV Or(IntV a, IntV b) { return _mm_or_si128(a, b); }
+		inline IntV ShiftLeft(IntV a, int count) { return _mm_slli_epi32(a, count); }
+		inline IntV ShiftRight(IntV a, int count) { return _mm_srli_epi32(a, count); }
+
+		inline FloatV CmpLE(FloatV a, FloatV b) { return _mm_cmple_ps(a, b); }
+		inline FloatV CmpGE(FloatV a, FloatV b) { return _mm_cmpge_ps(a, b); }
+		inline IntV CmpGT(IntV a, IntV b) { return _mm_cmpgt_epi32(a, b); }
+		inline IntV CmpLT(IntV a, IntV b) { return _mm_cmplt_epi32(a, b); }
+
+		//Lanes of mask that are all ones take a, the others take b (SSE2 has no blend)
+		inline FloatV Select(FloatV mask, FloatV a, FloatV b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+		inline IntV Select(IntV mask, IntV a, IntV b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+		inline FloatV ToFloat(IntV v) { return _mm_cvtepi32_ps(v); }
+		inline IntV ToInt(FloatV v) { return _mm_cvttps_epi32(v); }
+		//Rounding toward zero is one too high for negative values with a fraction, only exact below 2^31
+		inline FloatV Floor(FloatV v)
+		{
+			const FloatV truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+			return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, v), _mm_set1_ps(1.f)));
+		}
+
+		//No gather before AVX2, the lanes are loaded one by one
+		inline IntV Gather(const uint32_t* p, IntV indices)
+		{
+			alignas(16) uint32_t lanes[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(lanes), indices);
+			return _mm_setr_epi32(static_cast<int>(p[lanes[0]]), static_cast<int>(p[lanes[1]]), static_cast<int>(p[lanes[2]]), static_cast<int>(p[lanes[3]]));
+		}
+		inline FloatV AsFloat(IntV v) { return _mm_castsi128_ps(v); }
+		inline IntV AsInt(FloatV v) { return _mm_castps_si128(v); }
+
+		inline int MoveMask(FloatV mask) { return _mm_movemask_ps(mask); }
+#else
+		//No vector unit, every "vector" holds one lane
+		constexpr int LANES{ 1 };
+		struct FloatV { float v; };
+		struct IntV { int32_t v; };
+
+		inline FloatV AsFloat(IntV v) { FloatV f; std::memcpy(&f.v, &v.v, sizeof(float)); return f; }
+		inline IntV AsInt(FloatV v) { IntV i; std::memcpy(&i.v, &v.v, sizeof(float)); return i; }
+		inline IntV MaskFromBool(bool b) { return { b ? -1 : 0 }; }
+
+		inline FloatV Set1(float f) { return { f }; }
+		inline IntV Set1(int32_t i) { return { i }; }
+		inline IntV LaneIndices() { return { 0 }; }
+
+		inline FloatV Load(const float* p) { return { *p }; }
+		inline IntV Load(const uint32_t* p) { return { static_cast<int32_t>(*p) }; }
+		inline void Store(float* p, FloatV v) { *p = v.v; }
+		inline void Store(uint32_t* p, IntV v) { *p = static_cast<uint32_t>(v.v); }
+		inline IntV Load(const uint16_t* p) { return { static_cast<int32_t>(*p) }; }
+		inline void Store(uint16_t* p, IntV v) { *p = static_cast<uint16_t>(v.v); }
+
+		inline FloatV Add(FloatV a, FloatV b) { return { a.v + b.v }; }
+		inline FloatV Sub(FloatV a, FloatV b) { return { a.v - b.v }; }
+		inline FloatV Mul(FloatV a, FloatV b) { return { a.v * b.v }; }
+		inline FloatV Div(FloatV a, FloatV b) { return { a.v / b.v }; }
+		inline FloatV Min(FloatV a, FloatV b) { return { a.v < b.v ? a.v : b.v }; }
+		inline FloatV Max(FloatV a, FloatV b) { return { a.v > b.v ? a.v : b.v }; }
+		inline IntV Add(IntV a, IntV b) { return { a.v + b.v }; }
+		inline IntV Sub(IntV a, IntV b) { return { a.v - b.v }; }
+
+		inline FloatV And(FloatV a, FloatV b) { return AsFloat({ AsInt(a).v & AsInt(b).v }); }
+		inline FloatV Or(FloatV a, FloatV b) { return AsFloat({ AsInt(a).v | AsInt(b).v }); }
+		inline IntV And(IntV a, IntV b) { return { a.v & b.v }; }
+		inline IntV Or(IntV a, IntV b) { return { a.v | b.v }; }
+		inline IntV ShiftLeft(IntV a, int count) { return { static_cast<int32_t>(static_cast<uint32_t>(a.v) << count) }; }
+		inline IntV ShiftRight(IntV a, int count) { return { static_cast<int32_t>(static_cast<uint32_t>(a.v) >> count) }; }
+
+		inline FloatV CmpLE(FloatV a, FloatV b) { return AsFloat(MaskFromBool(a.v <= b.v)); }
+		inline FloatV CmpGE(FloatV a, FloatV b) { return AsFloat(MaskFromBool(a.v >= b.v)); }
+		inline IntV CmpGT(IntV a, IntV b) { return MaskFromBool(a.v > b.v); }
+		inline IntV CmpLT(IntV a, IntV b) { return MaskFromBool(a.v < b.v); }
+
+		inline FloatV Select(FloatV mask, FloatV a, FloatV b) { return AsInt(mask).v ? a : b; }
+		inline IntV Select(IntV mask, IntV a, IntV b) { return mask.v ? a : b; }
+
+		inline FloatV ToFloat(IntV v) { return { static_cast<float>(v.v) }; }
+		inline IntV ToInt(FloatV v) { return { static_cast<int32_t>(v.v) }; }
+		inline FloatV Floor(FloatV v) { return { std::floor(v.v) }; }
+
+		inline IntV Gather(const uint32_t* p, IntV indices) { return { static_cast<int32_t>(p[static_cast<uint32_t>(indices.v)]) }; }
+
+		inline int MoveMask(FloatV mask) { return AsInt(mask).v < 0 ? 1 : 0; }
+#endif
+
+		inline int MoveMask(IntV mask) { return MoveMask(AsFloat(mask)); }
+
+		inline float ReduceMax(FloatV v)
+		{
+			float lanes[LANES];
+			Store(lanes, v);
+
+			float maxValue = lanes[0];
+			for (int lane = 1; lane < LANES; ++lane)
+			{
+				maxValue = lanes[lane] > maxValue ? lanes[lane] : maxValue;
+			}
+			return maxValue;
+		}
+
+		//Loads and stores of the first count lanes, used where a full vector would run past the end of a row
+		//The other lanes of a float load get fill, so they can be kept out of a reduction
+		inline FloatV LoadPartial(const float* p, int count, float fill = 0.f)
+		{
+			float lanes[LANES];
+			std::fill_n(lanes, LANES, fill);
+			std::memcpy(lanes, p, count * sizeof(float));
+			return Load(lanes);
+		}
+
+		inline void StorePartial(float* p, FloatV v, int count)
+		{
+			float lanes[LANES];
+			Store(lanes, v);
+			std::memcpy(p, lanes, count * sizeof(float));
+		}
+
+		inline IntV LoadPartial(const uint32_t* p, int count)
+		{
+			uint32_t lanes[LANES]{};
+			std::memcpy(lanes, p, count * sizeof(uint32_t));
+			return Load(lanes);
+		}
+
+		inline void StorePartial(uint32_t* p, IntV v, int count)
+		{
+			uint32_t lanes[LANES];
+			Store(lanes, v);
+			std::memcpy(p, lanes, count * sizeof(uint32_t));
+		}
+
+		inline IntV LoadPartial(const uint16_t* p, int count)
+		{
+			uint16_t lanes[LANES]{};
+			std::memcpy(lanes, p, count * sizeof(uint16_t));
+			return Load(lanes);
+		}
+
+		inline void StorePartial(uint16_t* p, IntV v, int count)
+		{
+			uint16_t lanes[LANES];
+			Store(lanes, v);
+			std::memcpy(p, lanes, count * sizeof(uint16_t));
+		}
+
+		//Allocator for streams that are walked LANES elements at a time, the start is aligned to the widest vector
+		template<typename T>
+		struct AlignedAllocator
+		{
+			using value_type = T;
+			static constexpr std::align_val_t ALIGNMENT{ 32 };
+
+			AlignedAllocator() = default;
+			template<typename U>
+			AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+			T* allocate(size_t count) { return static_cast<T*>(::operator new(count * sizeof(T), ALIGNMENT)); }
+			void deallocate(T* p, size_t) noexcept { ::operator delete(p, ALIGNMENT); }
+
+			template<typename U>
+			bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+			template<typename U>
+			bool operator!=(const AlignedAllocator<U>&) const noexcept { return false; }
+		};
+
+		template<typename T>
+		using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+	}
+}
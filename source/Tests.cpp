@@ -0,0 +1,121 @@
+//Standard includes
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+//Project includes
+#include "Tests.h"
+#include "Renderer.h"
+#include "MemoryRenderTarget.h"
+#include "MaterialCache.h"
+
+using namespace dae;
+
+namespace
+{
+	bool Check(bool isPassed, const std::string& name)
+	{
+		std::cout << (isPassed ? "PASS " : "FAIL ") << name << std::endl;
+		return isPassed;
+	}
+
+	//The vehicle hides part of itself, so Hi-Z has to skip some blocks in every depth format
+	bool TestHiZCulling()
+	{
+		const DepthFormat formats[]{ DepthFormat::Float32, DepthFormat::Unorm16, DepthFormat::Fixed24, DepthFormat::ReversedFloat32 };
+		const char* formatNames[]{ "Float32", "Unorm16", "Fixed24", "ReversedFloat32" };
+
+		bool isPassed{ true };
+		for (int i = 0; i < 4; ++i)
+		{
+			MemoryRenderTarget target{ 640, 480 };
+			Renderer renderer{ &target, 1 };
+			renderer.SetDepthFormat(formats[i]);
+			renderer.SetSceneTime(0.f);
+			renderer.Render();
+
+			isPassed &= Check(renderer.GetHiZCulledBlockCount() > 0, std::string{ "Hi-Z culls occluded blocks in " } + formatNames[i]);
+		}
+		return isPassed;
+	}
+
+	std::vector<uint32_t> RenderFrame(Renderer& renderer, const MemoryRenderTarget& target, float sceneTime)
+	{
+		renderer.SetSceneTime(sceneTime);
+		renderer.Render();
+		const uint32_t* pPixels = target.GetPixels();
+		return { pPixels, pPixels + target.GetWidth() * target.GetHeight() };
+	}
+
+	//Largest difference of one color channel between two frames
+	int GetMaxChannelDifference(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b)
+	{
+		int maxDifference{};
+		for (size_t i = 0; i < a.size(); ++i)
+		{
+			for (int shift = 0; shift < 24; shift += 8)
+			{
+				const int difference = std::abs(static_cast<int>((a[i] >> shift) & 0xFF) - static_cast<int>((b[i] >> shift) & 0xFF));
+				maxDifference = std::max(maxDifference, difference);
+			}
+		}
+		return maxDifference;
+	}
+
+	//The visibility buffer has to shade like the forward path, mip levels included
+	//The close camera puts several triangles with different LODs in the same span
+	bool TestVisibilityBufferMatchesForward()
+	{
+		struct View
+		{
+			const char* name;
+			Vector3 origin;
+			float sceneTime;
+		};
+		const View views[]{ { "default camera", { 0.f, 0.f, -10.f }, 0.f }, { "turned vehicle", { 0.f, 0.f, -10.f }, 1.7f }, { "close camera", { 0.f, 0.f, -5.f }, 0.f } };
+
+		bool isPassed{ true };
+		for (const View& view : views)
+		{
+			MemoryRenderTarget target{ 640, 480 };
+			Renderer renderer{ &target, 1 };
+			renderer.SetCameraPose(view.origin, 0.f, 0.f);
+
+			const std::vector<uint32_t> forwardPixels = RenderFrame(renderer, target, view.sceneTime);
+			renderer.ToggleVisibilityBuffer();
+			const std::vector<uint32_t> visibilityPixels = RenderFrame(renderer, target, view.sceneTime);
+
+			isPassed &= Check(GetMaxChannelDifference(forwardPixels, visibilityPixels) <= 1, std::string{ "Visibility buffer matches forward with the " } + view.name);
+		}
+		return isPassed;
+	}
+
+	//Two meshes with the same texture share one material, releasing one of them keeps the texture for the other
+	bool TestSharedTexture()
+	{
+		MaterialCache cache{};
+		const MaterialHandle firstMesh = cache.AcquireMaterial("Resources/tuktuk.png");
+		const MaterialHandle secondMesh = cache.AcquireMaterial("Resources/tuktuk.png");
+
+		bool isPassed{ true };
+		isPassed &= Check(firstMesh == secondMesh && cache.GetTextureCount() == 1, "Meshes with the same texture share one material");
+
+		cache.Release(firstMesh);
+		isPassed &= Check(cache.GetMaterial(secondMesh).pDiffuse != nullptr && cache.GetTextureCount() == 1, "Shared texture outlives releasing one mesh");
+
+		cache.Release(secondMesh);
+		isPassed &= Check(cache.GetTextureCount() == 0, "Shared texture is freed with the last mesh");
+		return isPassed;
+	}
+}
+
+bool dae::RunTests()
+{
+	bool isPassed{ true };
+	isPassed &= TestHiZCulling();
+	isPassed &= TestVisibilityBufferMatchesForward();
+	isPassed &= TestSharedTexture();
+	return isPassed;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+namespace dae
+{
+	//Checks of renderer behaviour that a single image doesn't show, every check prints its result
+	//Returns true when all of them pass
+	bool RunTests();
+}
@@ -1,45 +1,263 @@
 #include "Texture.h"
 #include "Vector2.h"
 #include <SDL_image.h>
+#include <algorithm>
+#include <cmath>
 
 namespace dae
 {
-	Texture::Texture(SDL_Surface* pSurface) :
-		m_pSurface{ pSurface },
-		m_pSurfacePixels{ (uint32_t*)pSurface->pixels }
+	Texture::Texture(const SDL_Surface* pSurface)
 	{
-	}
+		CreateMipLevels(pSurface->w, pSurface->h);
 
-	Texture::~Texture()
-	{
-		if (m_pSurface)
+		//Rows of the surface can be padded
+		const MipLevel& level = m_MipLevels[0];
+		for (int y = 0; y < level.height; ++y)
 		{
-			SDL_FreeSurface(m_pSurface);
-			m_pSurface = nullptr;
+			const uint32_t* pRow = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(pSurface->pixels) + y * pSurface->pitch);
+			for (int x = 0; x < level.width; ++x)
+			{
+				level.pTexels[GetTexelIndex(level, x, y)] = pRow[x];
+			}
 		}
+
+		CreateMipChain();
 	}
 
 	Texture* Texture::LoadFromFile(const std::string& path)
 	{
 		//Load SDL_Surface using IMG_LOAD
-		return new Texture{ IMG_Load(path.c_str()) };
+		SDL_Surface* pSurface = IMG_Load(path.c_str());
+		if (!pSurface)
+		{
+			return nullptr;
+		}
+
+		//Converted once, so sampling never goes through the format of the file
+		SDL_Surface* pConvertedSurface = SDL_ConvertSurfaceFormat(pSurface, TEXEL_FORMAT, 0);
+		SDL_FreeSurface(pSurface);
+		if (!pConvertedSurface)
+		{
+			return nullptr;
+		}
+
+		Texture* pTexture = new Texture{ pConvertedSurface };
+		SDL_FreeSurface(pConvertedSurface);
+		return pTexture;
 	}
 
-	ColorRGB Texture::Sample(const Vector2& uv) const
+	void Texture::Sample(const Sampler& sampler, simd::FloatV u, simd::FloatV v, int mipLevel, simd::FloatV& red, simd::FloatV& green, simd::FloatV& blue) const
 	{
-		//Set x & y for later usage
-		const int x = static_cast<int>(uv.x * m_pSurface->w);
-		const int y = static_cast<int>(uv.y * m_pSurface->h);
+		using namespace simd;
+
+		const MipLevel& level = m_MipLevels[mipLevel];
+		const float width = static_cast<float>(level.width);
+		const float height = static_cast<float>(level.height);
+		const FloatV x = Mul(u, Set1(width));
+		const FloatV y = Mul(v, Set1(height));
+
+		if (sampler.filter == TextureFilter::Point)
+		{
+			const IntV columns = ToInt(ApplyAddressMode(Floor(x), width, sampler.addressU));
+			const IntV rows = ToInt(ApplyAddressMode(Floor(y), height, sampler.addressV));
+			UnpackTexels(Gather(level.pTexels, GetTexelIndices(level, columns, rows)), red, green, blue);
+			return;
+		}
+
+		//Texel centers are at half coordinates, the four texels around the point are blended by its distance to them
+		const FloatV halfV = Set1(0.5f);
+		const FloatV oneV = Set1(1.f);
+		const FloatV x0 = Floor(Sub(x, halfV));
+		const FloatV y0 = Floor(Sub(y, halfV));
+		const FloatV fractionX = Sub(Sub(x, halfV), x0);
+		const FloatV fractionY = Sub(Sub(y, halfV), y0);
 
-		//Prepare color get & calculate pixel index on texture
-		Uint32 pixel = m_pSurfacePixels[x + y * m_pSurface->w];
-		Uint8 r{}, g{}, b{};
+		const IntV column0 = ToInt(ApplyAddressMode(x0, width, sampler.addressU));
+		const IntV column1 = ToInt(ApplyAddressMode(Add(x0, oneV), width, sampler.addressU));
+		const IntV row0 = ToInt(ApplyAddressMode(y0, height, sampler.addressV));
+		const IntV row1 = ToInt(ApplyAddressMode(Add(y0, oneV), height, sampler.addressV));
 
-		//Get RGB color from texture
-		SDL_GetRGB(pixel, m_pSurface->format, &r, &g, &b);
+		FloatV red00, green00, blue00, red10, green10, blue10, red01, green01, blue01, red11, green11, blue11;
+		UnpackTexels(Gather(level.pTexels, GetTexelIndices(level, column0, row0)), red00, green00, blue00);
+		UnpackTexels(Gather(level.pTexels, GetTexelIndices(level, column1, row0)), red10, green10, blue10);
+		UnpackTexels(Gather(level.pTexels, GetTexelIndices(level, column0, row1)), red01, green01, blue01);
+		UnpackTexels(Gather(level.pTexels, GetTexelIndices(level, column1, row1)), red11, green11, blue11);
+
+		const auto blend = [&](FloatV value00, FloatV value10, FloatV value01, FloatV value11)
+			{
+				const FloatV top = Add(value00, Mul(Sub(value10, value00), fractionX));
+				const FloatV bottom = Add(value01, Mul(Sub(value11, value01), fractionX));
+				return Add(top, Mul(Sub(bottom, top), fractionY));
+			};
+		red = blend(red00, red10, red01, red11);
+		green = blend(green00, green10, green01, green11);
+		blue = blend(blue00, blue10, blue01, blue11);
+	}
+
+	int Texture::GetMipLevel(const Vector2& uvGradientX, const Vector2& uvGradientY) const
+	{
+		//Squared number of texels of the first level a step of one pixel crosses, along the longer screen axis
+		const float width = static_cast<float>(m_MipLevels[0].width);
+		const float height = static_cast<float>(m_MipLevels[0].height);
+		const float footprintX = Square(uvGradientX.x * width) + Square(uvGradientX.y * height);
+		const float footprintY = Square(uvGradientY.x * width) + Square(uvGradientY.y * height);
+		const float footprint = std::max(footprintX, footprintY);
+
+		//Magnified, also catches NaN of degenerate gradients
+		if (!(footprint > 1.f))
+		{
+			return 0;
+		}
+
+		//Every level halves the footprint, log2 of the squared footprint counts twice. Rounded to the nearest level
+		const int level = static_cast<int>(0.5f * std::log2(footprint) + 0.5f);
+		return std::min(level, GetMipLevelCount() - 1);
+	}
+
+	void Texture::CreateMipLevels(int width, int height)
+	{
+		//All levels share one allocation, sized up front so the pointers stay valid
+		size_t nrTexels{};
+		std::vector<size_t> levelOffsets{};
+		while (true)
+		{
+			MipLevel level{ width, height };
+			while (level.tileShift < MAX_TILE_SHIFT && (1 << level.tileShift) < std::min(width, height))
+			{
+				++level.tileShift;
+			}
+			const int tileSize = 1 << level.tileShift;
+			level.tilesPerRow = (width + tileSize - 1) / tileSize;
+			const int tilesPerColumn = (height + tileSize - 1) / tileSize;
+
+			levelOffsets.push_back(nrTexels);
+			nrTexels += static_cast<size_t>(level.tilesPerRow) * tilesPerColumn << (2 * level.tileShift);
+			m_MipLevels.push_back(level);
+
+			if (width == 1 && height == 1)
+			{
+				break;
+			}
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+
+		m_Texels.resize(nrTexels);
+		for (size_t i = 0; i < m_MipLevels.size(); ++i)
+		{
+			m_MipLevels[i].pTexels = m_Texels.data() + levelOffsets[i];
+		}
+	}
+
+	void Texture::CreateMipChain()
+	{
+		//Box filter, every texel averages the 2x2 texels it covers in the level before. Odd sizes repeat the last row or column
+		for (size_t levelIndex = 1; levelIndex < m_MipLevels.size(); ++levelIndex)
+		{
+			const MipLevel& source = m_MipLevels[levelIndex - 1];
+			const MipLevel& level = m_MipLevels[levelIndex];
+
+			for (int y = 0; y < level.height; ++y)
+			{
+				for (int x = 0; x < level.width; ++x)
+				{
+					const int sourceX[2]{ std::min(2 * x, source.width - 1), std::min(2 * x + 1, source.width - 1) };
+					const int sourceY[2]{ std::min(2 * y, source.height - 1), std::min(2 * y + 1, source.height - 1) };
+
+					//Channel by channel, starting at red in the lowest byte
+					uint32_t texel{};
+					for (int shift = 0; shift < 32; shift += 8)
+					{
+						uint32_t sum{};
+						for (int row = 0; row < 2; ++row)
+						{
+							for (int column = 0; column < 2; ++column)
+							{
+								sum += (source.pTexels[GetTexelIndex(source, sourceX[column], sourceY[row])] >> shift) & 0xFF;
+							}
+						}
+
+						//Rounded average
+						texel |= ((sum + 2) / 4) << shift;
+					}
+					level.pTexels[GetTexelIndex(level, x, y)] = texel;
+				}
+			}
+		}
+	}
+
+	simd::IntV Texture::GetTexelIndices(const MipLevel& level, simd::IntV x, simd::IntV y)
+	{
+		using namespace simd;
+
+		//Same as GetTexelIndex
+		const auto spreadBits = [](IntV value)
+			{
+				value = And(Or(value, ShiftLeft(value, 4)), Set1(0x0F0F));
+				value = And(Or(value, ShiftLeft(value, 2)), Set1(0x3333));
+				value = And(Or(value, ShiftLeft(value, 1)), Set1(0x5555));
+				return value;
+			};
+
+		//No 32-bit multiply before SSE4.1, the tile index is exact in float for any texture that fits in memory
+		const IntV tileMaskV = Set1((1 << level.tileShift) - 1);
+		const FloatV tileRows = ToFloat(ShiftRight(y, level.tileShift));
+		const FloatV tileColumns = ToFloat(ShiftRight(x, level.tileShift));
+		const IntV tileIndices = ToInt(Add(Mul(tileRows, Set1(static_cast<float>(level.tilesPerRow))), tileColumns));
+		return Or(ShiftLeft(tileIndices, 2 * level.tileShift), Or(spreadBits(And(x, tileMaskV)), ShiftLeft(spreadBits(And(y, tileMaskV)), 1)));
+	}
+
+	simd::FloatV Texture::ApplyAddressMode(simd::FloatV coordinate, float size, AddressMode mode)
+	{
+		using namespace simd;
+
+		const FloatV sizeV = Set1(size);
+		switch (mode)
+		{
+		case AddressMode::Wrap:
+			coordinate = Sub(coordinate, Mul(Floor(Mul(coordinate, Set1(1.f / size))), sizeV));
+			break;
+		case AddressMode::Mirror:
+		{
+			//Every other repetition runs backwards
+			const FloatV periodV = Set1(2.f * size);
+			coordinate = Sub(coordinate, Mul(Floor(Mul(coordinate, Set1(0.5f / size))), periodV));
+			coordinate = Select(CmpGE(coordinate, sizeV), Sub(Sub(periodV, Set1(1.f)), coordinate), coordinate);
+			break;
+		}
+		case AddressMode::Clamp:
+			break;
+		}
+
+		//Also the clamp of wrap and mirror, where huge coordinates lose the precision to land inside
+		//Max comes first and returns its second operand for NaN, so NaN ends up at 0
+		return Min(Max(coordinate, Set1(0.f)), Set1(size - 1.f));
+	}
+
+	void Texture::UnpackTexels(simd::IntV texels, simd::FloatV& red, simd::FloatV& green, simd::FloatV& blue)
+	{
+		using namespace simd;
+
+		const IntV channelMaskV = Set1(0xFF);
+		const FloatV invMaxColorValueV = Set1(1.f / 255.f);
+		red = Mul(ToFloat(And(texels, channelMaskV)), invMaxColorValueV);
+		green = Mul(ToFloat(And(ShiftRight(texels, 8), channelMaskV)), invMaxColorValueV);
+		blue = Mul(ToFloat(And(ShiftRight(texels, 16), channelMaskV)), invMaxColorValueV);
+	}
+
+	uint32_t Texture::GetTexelIndex(const MipLevel& level, int x, int y)
+	{
+		//Spreads the bits of a coordinate inside the tile to every other bit
+		const auto spreadBits = [](uint32_t value)
+			{
+				value = (value | (value << 4)) & 0x0F0F;
+				value = (value | (value << 2)) & 0x3333;
+				value = (value | (value << 1)) & 0x5555;
+				return value;
+			};
 
-		//Convert to colorRGB
-		const float maxColorValue = 255.f;
-		return ColorRGB{ r / maxColorValue, g / maxColorValue, b / maxColorValue };
+		const uint32_t tileMask = (1u << level.tileShift) - 1;
+		const uint32_t tileIndex = static_cast<uint32_t>((y >> level.tileShift) * level.tilesPerRow + (x >> level.tileShift));
+		return (tileIndex << (2 * level.tileShift)) | spreadBits(x & tileMask) | (spreadBits(y & tileMask) << 1);
 	}
-}
\ No newline at end of file
+}
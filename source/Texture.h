@@ -1,24 +1,85 @@
 #pragma once
 #include <SDL_surface.h>
 #include <string>
+#include <vector>
 #include "ColorRGB.h"
+#include "SIMD.h"
 
 namespace dae
 {
 	struct Vector2;
 
+	//What happens to uv outside of [0, 1]
+	enum class AddressMode
+	{
+		Wrap,
+		Clamp,
+		Mirror
+	};
+
+	enum class TextureFilter
+	{
+		Point,
+		Bilinear
+	};
+
+	//Defaults to point sampling, which is what every material was drawn with before filtering existed
+	struct Sampler
+	{
+		AddressMode addressU{ AddressMode::Wrap };
+		AddressMode addressV{ AddressMode::Wrap };
+		TextureFilter filter{ TextureFilter::Point };
+	};
+
 	class Texture
 	{
 	public:
-		~Texture();
+		~Texture() = default;
 
+		//Returns nullptr when the image can't be loaded
 		static Texture* LoadFromFile(const std::string& path);
-		ColorRGB Sample(const Vector2& uv) const;
+
+		//Samples LANES uvs of one mip level at once, the channels are in [0, 1]
+		//Every uv is addressed inside the level, also infinite and NaN ones, so lanes that aren't used don't have to be masked
+		void Sample(const Sampler& sampler, simd::FloatV u, simd::FloatV v, int mipLevel, simd::FloatV& red, simd::FloatV& green, simd::FloatV& blue) const;
+
+		//Level whose texels are closest to the size of a pixel, from the change of uv per pixel along x and y on screen
+		int GetMipLevel(const Vector2& uvGradientX, const Vector2& uvGradientY) const;
+		int GetMipLevelCount() const { return static_cast<int>(m_MipLevels.size()); }
 
 	private:
-		Texture(SDL_Surface* pSurface);
+		//Every level is half the size of the one before, rounded down, down to 1x1
+		//Texels are stored in square tiles of 2^tileShift texels per side, in Morton order inside a tile and row by row between tiles
+		//Texels that are close in u and v are close in memory, a 4x4 block is one cache line and a full tile a page
+		struct MipLevel
+		{
+			int width{};
+			int height{};
+			int tileShift{};
+			int tilesPerRow{};
+			uint32_t* pTexels{};
+		};
+
+		//Side of the tiles of the larger levels, a level with a shorter side uses tiles that just fit it
+		static constexpr int MAX_TILE_SHIFT{ 5 };
+
+		//Texels are packed as red in the lowest byte, then green, blue and alpha, whatever format the image had
+		static constexpr uint32_t TEXEL_FORMAT{ SDL_PIXELFORMAT_ABGR8888 };
+
+		Texture(const SDL_Surface* pSurface);
+
+		//Sizes and tiles every level and allocates their texels
+		void CreateMipLevels(int width, int height);
+		void CreateMipChain();
+
+		static uint32_t GetTexelIndex(const MipLevel& level, int x, int y);
+		static simd::IntV GetTexelIndices(const MipLevel& level, simd::IntV x, simd::IntV y);
+		//Texel coordinates after addressing, as whole floats in [0, size - 1]
+		static simd::FloatV ApplyAddressMode(simd::FloatV coordinate, float size, AddressMode mode);
+		static void UnpackTexels(simd::IntV texels, simd::FloatV& red, simd::FloatV& green, simd::FloatV& blue);
 
-		SDL_Surface* m_pSurface{ nullptr };
-		uint32_t* m_pSurfacePixels{ nullptr };
+		std::vector<MipLevel> m_MipLevels{};
+		//Every level, starting with the full image
+		std::vector<uint32_t> m_Texels{};
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,106 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+using namespace dae;
+
+ThreadPool::ThreadPool(uint32_t nrThreads)
+{
+	//hardware_concurrency is allowed to return 0
+	const uint32_t nrWorkers = std::max(nrThreads, 1u) - 1;
+
+	m_Workers.reserve(nrWorkers);
+	for (uint32_t i = 0; i < nrWorkers; ++i)
+	{
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_IsStopping = true;
+	}
+	m_JobCondition.notify_all();
+
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+}
+
+void ThreadPool::ParallelFor(uint32_t count, const std::function<void(uint32_t)>& job)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	//Nothing to share, skip the wake up
+	if (m_Workers.empty() || count == 1)
+	{
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			job(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		m_pJob = &job;
+		m_JobCount = count;
+		m_NextIndex = 0;
+		m_FinishedWorkers = 0;
+		++m_Generation;
+	}
+	m_JobCondition.notify_all();
+
+	//Help out instead of idling
+	RunJob(job, count);
+
+	//Every worker has to check in, otherwise one could still be reading the job
+	std::unique_lock<std::mutex> lock{ m_Mutex };
+	m_DoneCondition.wait(lock, [this]() { return m_FinishedWorkers == m_Workers.size(); });
+	m_pJob = nullptr;
+}
+
+void ThreadPool::WorkerLoop()
+{
+	uint64_t lastGeneration{};
+	while (true)
+	{
+		const std::function<void(uint32_t)>* pJob{ nullptr };
+		uint32_t count{};
+		{
+			std::unique_lock<std::mutex> lock{ m_Mutex };
+			m_JobCondition.wait(lock, [&]() { return m_IsStopping || m_Generation != lastGeneration; });
+			if (m_IsStopping)
+			{
+				return;
+			}
+
+			lastGeneration = m_Generation;
+			pJob = m_pJob;
+			count = m_JobCount;
+		}
+
+		RunJob(*pJob, count);
+
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+			++m_FinishedWorkers;
+		}
+		m_DoneCondition.notify_one();
+	}
+}
+
+void ThreadPool::RunJob(const std::function<void(uint32_t)>& job, uint32_t count)
+{
+	//Hand out indices one by one so fast threads pick up the slack of slow ones
+	for (uint32_t i = m_NextIndex++; i < count; i = m_NextIndex++)
+	{
+		job(i);
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+//Standard includes
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dae
+{
+	class ThreadPool final
+	{
+	public:
+		//The calling thread also works on every job, so nrThreads includes it
+		ThreadPool(uint32_t nrThreads = std::thread::hardware_concurrency());
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) noexcept = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+
+		//Runs job(0) ... job(count - 1) spread over all threads, returns when every call finished
+		void ParallelFor(uint32_t count, const std::function<void(uint32_t)>& job);
+
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()) + 1; };
+
+	private:
+		std::vector<std::thread> m_Workers{};
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_JobCondition{};
+		std::condition_variable m_DoneCondition{};
+
+		const std::function<void(uint32_t)>* m_pJob{ nullptr };
+		uint32_t m_JobCount{};
+		std::atomic<uint32_t> m_NextIndex{};
+
+		uint64_t m_Generation{};
+		size_t m_FinishedWorkers{};
+		bool m_IsStopping{ false };
+
+		void WorkerLoop();
+		void RunJob(const std::function<void(uint32_t)>& job, uint32_t count);
+	};
+}
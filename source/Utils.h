@@ -171,6 +171,37 @@ namespace dae
 			return true;
 #endif
 		}
+
+		//Axis aligned box around the vertices, and a sphere around the center of that box
+		static Bounds CalculateBounds(const std::vector<Vertex>& vertices)
+		{
+			Bounds bounds{};
+			if (vertices.empty())
+			{
+				return bounds;
+			}
+
+			bounds.min = vertices[0].position;
+			bounds.max = vertices[0].position;
+			for (const Vertex& vertex : vertices)
+			{
+				bounds.min.x = std::min(bounds.min.x, vertex.position.x);
+				bounds.min.y = std::min(bounds.min.y, vertex.position.y);
+				bounds.min.z = std::min(bounds.min.z, vertex.position.z);
+				bounds.max.x = std::max(bounds.max.x, vertex.position.x);
+				bounds.max.y = std::max(bounds.max.y, vertex.position.y);
+				bounds.max.z = std::max(bounds.max.z, vertex.position.z);
+			}
+
+			bounds.center = (bounds.min + bounds.max) * 0.5f;
+			for (const Vertex& vertex : vertices)
+			{
+				bounds.radius = std::max(bounds.radius, (vertex.position - bounds.center).SqrMagnitude());
+			}
+			bounds.radius = sqrtf(bounds.radius);
+
+			return bounds;
+		}
 #pragma warning(pop)
 	}
 }
\ No newline at end of file
@@ -1,15 +1,25 @@
 //External includes
+#ifdef _WIN32
 #include "vld.h"
+#endif
 #include "SDL.h"
 #include "SDL_surface.h"
 #undef main
 
 //Standard includes
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
 
 //Project includes
 #include "Timer.h"
 #include "Renderer.h"
+#include "Presenter.h"
+#include "MemoryRenderTarget.h"
+#include "Tests.h"
+#include "BatchRenderer.h"
 
 using namespace dae;
 
@@ -19,18 +29,116 @@ void ShutDown(SDL_Window* pWindow)
 	SDL_Quit();
 }
 
-int main(int argc, char* args[])
+//Renders a fixed number of frames to memory, without initializing the video subsystem
+int RunHeadless(int width, int height, int nrFrames)
 {
-	//Unreferenced parameters
-	(void)argc;
-	(void)args;
+	const auto pTimer = new Timer();
+	const auto pRenderTarget = new MemoryRenderTarget(width, height);
+	const auto pRenderer = new Renderer(pRenderTarget);
 
-	//Create window + surfaces
-	SDL_Init(SDL_INIT_VIDEO);
+	pTimer->Start();
+	for (int i = 0; i < nrFrames; ++i)
+	{
+		pRenderer->Update(pTimer);
+		pRenderer->Render();
+		pTimer->Update();
+	}
+	pTimer->Stop();
+
+	const float totalTime = pTimer->GetTotal();
+	std::cout << nrFrames << " frames in " << totalTime << "s, " << nrFrames / totalTime << " FPS" << std::endl;
+
+	bool isSaved = !pRenderer->SaveBufferToImage();
+	if (isSaved)
+		std::cout << "Last frame saved!" << std::endl;
+	else
+		std::cout << "Something went wrong. Last frame not saved!" << std::endl;
 
+	delete pRenderer;
+	delete pRenderTarget;
+	delete pTimer;
+
+	SDL_Quit();
+	return isSaved ? 0 : 1;
+}
+
+//Renders an image sequence with a fixed time step, options come after the frame count:
+//--camera <keyframe file>, --timestep <seconds>, --output <path prefix>, --jobs <frames rendered at once>
+int RunBatch(int width, int height, int nrFrames, int argc, char* args[])
+{
+	const char* pCameraPath{ nullptr };
+	float timeStep{ 1.f / 30.f };
+	std::string outputPrefix{ "Rasterizer_Frame" };
+	uint32_t nrJobs{ 0 };
+	for (int i = 0; i + 1 < argc; i += 2)
+	{
+		if (std::strcmp(args[i], "--camera") == 0)
+			pCameraPath = args[i + 1];
+		else if (std::strcmp(args[i], "--timestep") == 0)
+			timeStep = static_cast<float>(std::atof(args[i + 1]));
+		else if (std::strcmp(args[i], "--output") == 0)
+			outputPrefix = args[i + 1];
+		else if (std::strcmp(args[i], "--jobs") == 0)
+			nrJobs = static_cast<uint32_t>(std::max(std::atoi(args[i + 1]), 0));
+	}
+
+	const auto pTimer = new Timer();
+	const auto pBatchRenderer = new BatchRenderer(width, height, nrJobs);
+
+	bool isSaved{ true };
+	if (pCameraPath && !pBatchRenderer->LoadCameraPath(pCameraPath))
+	{
+		std::cout << "Camera path " << pCameraPath << " could not be loaded!" << std::endl;
+		isSaved = false;
+	}
+	else
+	{
+		pTimer->Start();
+		isSaved = pBatchRenderer->Render(nrFrames, timeStep, outputPrefix);
+		pTimer->Update();
+		pTimer->Stop();
+
+		const float totalTime = pTimer->GetTotal();
+		std::cout << nrFrames << " frames with " << pBatchRenderer->GetJobCount() << " jobs in " << totalTime << "s, " << nrFrames / totalTime << " FPS" << std::endl;
+		if (!isSaved)
+			std::cout << "Something went wrong. Not every frame was saved!" << std::endl;
+	}
+
+	delete pBatchRenderer;
+	delete pTimer;
+
+	SDL_Quit();
+	return isSaved ? 0 : 1;
+}
+
+int main(int argc, char* args[])
+{
 	const uint32_t width = 640;
 	const uint32_t height = 480;
 
+	//"--headless [frames]" renders without a window
+	if (argc > 1 && std::strcmp(args[1], "--headless") == 0)
+	{
+		const int nrFrames = argc > 2 ? std::max(std::atoi(args[2]), 1) : 100;
+		return RunHeadless(width, height, nrFrames);
+	}
+
+	//"--test" runs the checks in Tests.cpp, the exit code is 1 when one of them fails
+	if (argc > 1 && std::strcmp(args[1], "--test") == 0)
+	{
+		return RunTests() ? 0 : 1;
+	}
+
+	//"--batch <frames> [options]" writes an image sequence, see RunBatch
+	if (argc > 2 && std::strcmp(args[1], "--batch") == 0)
+	{
+		const int nrFrames = std::max(std::atoi(args[2]), 1);
+		return RunBatch(width, height, nrFrames, argc - 3, args + 3);
+	}
+
+	//Create window + surfaces
+	SDL_Init(SDL_INIT_VIDEO);
+
 	SDL_Window* pWindow = SDL_CreateWindow(
 		"Rasterizer - W6 DEMO",
 		SDL_WINDOWPOS_UNDEFINED,
@@ -42,7 +150,8 @@ int main(int argc, char* args[])
 
 	//Initialize "framework"
 	const auto pTimer = new Timer();
-	const auto pRenderer = new Renderer(pWindow);
+	const auto pPresenter = new Presenter(pWindow);
+	const auto pRenderer = new Renderer(pPresenter);
 
 	//Start loop
 	pTimer->Start();
@@ -65,6 +174,18 @@ int main(int argc, char* args[])
 					takeScreenshot = true;
 				if (e.key.keysym.scancode == SDL_SCANCODE_F4)
 					pRenderer->ToggleDepthBuffer();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F5)
+					pRenderer->ToggleVisibilityBuffer();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F6)
+					pRenderer->ToggleSwizzledLayout();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F7)
+					pRenderer->CycleDepthFormat();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F8)
+					pRenderer->ToggleDynamicResolution();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F9)
+					pRenderer->CycleSampleCount();
+				if (e.key.keysym.scancode == SDL_SCANCODE_F10)
+					pRenderer->ToggleTextureFilter();
 
 				break;
 			}
@@ -99,6 +220,7 @@ int main(int argc, char* args[])
 
 	//Shutdown "framework"
 	delete pRenderer;
+	delete pPresenter;
 	delete pTimer;
 
 	ShutDown(pWindow);